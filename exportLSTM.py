@@ -0,0 +1,35 @@
+import sys
+import torch
+
+
+# parameter order expected by LstmModel::Read in random_noise_client/model/lstm_predictor.cc
+parameter_names = ['lstm.weight_ih_l0', 'lstm.weight_hh_l0', 'lstm.bias_ih_l0', 'lstm.bias_hh_l0',
+                   'fc_1.weight', 'fc_1.bias', 'fc_2.weight', 'fc_2.bias', 'fc_3.weight', 'fc_3.bias',
+                   'fc.weight', 'fc.bias']
+
+def writeSection(file, name, values):
+    values = list(values)
+    file.write(name + " " + str(len(values)) + "\n")
+    file.write(" ".join(repr(float(value)) for value in values) + "\n")
+
+def main():
+    # the scaler is the one the model was trained with, fitted on the training split only:
+    # scaler.txt of masticc-dataset-prep or savedModel1.scaler.txt of trainLSTM.py
+    if len(sys.argv) != 4:
+        sys.exit("usage: exportLSTM.py <model.pth> <output.txt> <scaler.txt>")
+    model_file, output_file, scaler_file = sys.argv[1:]
+
+    state = torch.load(model_file)
+    input_size = state['lstm.weight_ih_l0'].shape[1]
+    hidden_size = state['lstm.weight_hh_l0'].shape[1]
+
+    with open(output_file, "w") as file:
+        file.write("lstm1 " + str(input_size) + " " + str(hidden_size) + "\n")
+        with open(scaler_file) as scaler:
+            scaler.readline()  # "scaler <features>"
+            file.write(scaler.read())
+        for name in parameter_names:
+            writeSection(file, name, state[name].flatten().tolist())
+    print("Exported " + model_file + " to " + output_file)
+
+main()
@@ -11,9 +11,6 @@ for bottleneckRate in bottleneckRates:
     print(noiseRates)
     for noiseRate in noiseRates:
         for noiseSize in noiseSizes:
-            noiseInterval = (noiseSize * 8) / (noiseRate * 1e3)
-            print(f'bottleneck {bottleneckRate} Mbps, noise {noiseRate} Mbps {noiseSize} bytes {noiseInterval} ms')
-            os.system(f'./ns3 run "network_topology --meanNoiseInterval={noiseInterval} --meanNoiseSize={noiseSize} --bottleneckRate={bottleneckRate} --bottleneckDelay=0 --verbose=False"')
-            os.chdir('masticc')
-            os.system(f'python3 process_pcap.py {bottleneckRate}')
-            os.chdir('..')
+            print(f'bottleneck {bottleneckRate} Mbps, noise {noiseRate} Mbps {noiseSize} bytes')
+            os.system(f'./ns3 run "network_topology --noiseRate={noiseRate} --meanNoiseSize={noiseSize} --bottleneckRate={bottleneckRate} --bottleneckDelay=0 --verbose=False"')
+            os.system(f'./ns3 run "masticc-process-pcap {bottleneckRate}" --cwd=masticc')
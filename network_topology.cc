@@ -18,6 +18,7 @@
 #include "ns3/flow-monitor.h"
 #include "ns3/flow-monitor-helper.h"
 #include "ns3/netanim-module.h"
+#include "ns3/traffic-control-module.h"
 
 using namespace ns3;
 NS_LOG_COMPONENT_DEFINE("MasticcTopology");
@@ -31,6 +32,36 @@ main(int argc, char * argv[]) {
     uint32_t bottleneckDelay = 10; // ms
     float meanNoiseInterval = 10; // ms
     uint32_t meanNoiseSize = 1000; // bytes
+    std::string traceMode = "pcap";
+    uint64_t traceBudget = 0; // bytes per device
+    uint32_t traceSnapLen = 0; // bytes
+    std::string flowMonitorScope = "all";
+    uint32_t flowSampleInterval = 100; // ms
+    uint32_t replications = 1;
+    uint32_t jobs = 0;
+    bool adaptiveClient = false;
+    double warmup = 0; // s
+    std::string variants = "6";
+    bool evaluate = false;
+    bool onlineLearning = false;
+    double noiseRate = 0; // Mbps
+    std::string noiseSizes = "Normal";
+    uint32_t noiseBurst = 1;
+    std::string noiseProfile = "Constant";
+    double noiseProfileRate = 0; // Mbps
+    double noiseProfilePeriod = 10; // s
+    std::string noiseTrace = "";
+    double noiseTraceScale = 1;
+    std::string scheduler = "Map";
+    bool memoryReport = false;
+    bool reflector = false;
+    uint32_t reflectorSample = 1;
+    uint32_t reflectorBatch = 1;
+    uint32_t reflectorBatchTimeout = 0; // ms
+    std::string queueDisc = "None";
+    bool ecn = false;
+    bool telemetry = false;
+    uint32_t telemetryInterval = 100; // ms
     CommandLine cmd(__FILE__);
     cmd.AddValue("nClients", "Number of clients connected to R1", nClients);
     cmd.AddValue("accessRate", "Rate of access links (Mbps)", accessRate);
@@ -39,86 +70,314 @@ main(int argc, char * argv[]) {
     cmd.AddValue("bottleneckDelay", "Delay of access links (ms)", bottleneckDelay);
     cmd.AddValue("meanNoiseInterval", "Average interval between noise packets (ms)", meanNoiseInterval);
     cmd.AddValue("meanNoiseSize", "Average size of noise packets (bytes)", meanNoiseSize);
+    cmd.AddValue("noiseRate", "Average noise rate, overrides meanNoiseInterval (Mbps, 0 = off)", noiseRate);
+    cmd.AddValue("noiseSizes", "Noise size distribution: Normal, LogNormal, Bimodal or Empirical", noiseSizes);
+    cmd.AddValue("noiseBurst", "Noise packets sent back to back per send event", noiseBurst);
+    cmd.AddValue("noiseProfile", "Noise rate over time, from noiseRate to noiseProfileRate: Constant, Step, Ramp or Sinusoid", noiseProfile);
+    cmd.AddValue("noiseProfileRate", "Rate the noise profile moves to (Mbps)", noiseProfileRate);
+    cmd.AddValue("noiseProfilePeriod", "Step time, ramp duration or sinusoid period of the noise profile (s)", noiseProfilePeriod);
+    cmd.AddValue("noiseTrace", "Replay this masticc-convert-trace output as noise instead of the random distributions", noiseTrace);
+    cmd.AddValue("noiseTraceScale", "Factor applied to the intervals of the noise trace", noiseTraceScale);
     cmd.AddValue("verbose", "Tell echo applications to log if true", verbose);
+    cmd.AddValue("traceMode", "Capture format: pcap, summary (header summaries only) or none", traceMode);
+    cmd.AddValue("traceBudget", "Maximum summary bytes per device, older records are overwritten (0 = unbounded)", traceBudget);
+    cmd.AddValue("traceSnapLen", "Packet bytes kept after each header summary", traceSnapLen);
+    cmd.AddValue("flowMonitorScope", "Nodes with flow probes: all, endpoints (nodes running applications) or none", flowMonitorScope);
+    cmd.AddValue("flowSampleInterval", "Interval of the per-flow statistics in traces/flows.csv (ms, 0 = off)", flowSampleInterval);
+    cmd.AddValue("replications", "Independent runs with consecutive RngRun values, forked after the setup", replications);
+    cmd.AddValue("jobs", "Replications run at the same time (0 = number of cores)", jobs);
+    cmd.AddValue("adaptiveClient", "Use the LSTM-paced RandomNoiseClient as the main client instead of a UdpEchoClient", adaptiveClient);
+    cmd.AddValue("warmup", "Simulate this long once, then fork one branch per variant (s, 0 = off)", warmup);
+    cmd.AddValue("variants", "Comma separated variants forked after the warm-up: pacingExponent[:modelFile]", variants);
+    cmd.AddValue("evaluate", "Score the predictions of the adaptive client against the true bottleneck state", evaluate);
+    cmd.AddValue("onlineLearning", "Fine-tune the output layer of the adaptive client's model with the true bottleneck state", onlineLearning);
+    cmd.AddValue("scheduler", "Event scheduler: Map, Heap, Calendar, PriorityQueue or TimingWheel", scheduler);
+    cmd.AddValue("memoryReport", "Print the memory held by the RandomNoiseClients after the run", memoryReport);
+    cmd.AddValue("reflector", "Serve with a timestamping EchoReflector; the adaptive client predicts from the forward delay", reflector);
+    cmd.AddValue("reflectorSample", "The reflector returns one of every N stamped packets", reflectorSample);
+    cmd.AddValue("reflectorBatch", "Stamps the reflector returns in one reply", reflectorBatch);
+    cmd.AddValue("reflectorBatchTimeout", "Longest wait of a partial reflector batch (ms, 0 = only packets read together)", reflectorBatchTimeout);
+    cmd.AddValue("queueDisc", "Queue disc of the R1->R2 bottleneck: None (the default FqCoDel), DropTail, Red or CoDel (both ECN marking)", queueDisc);
+    cmd.AddValue("ecn", "Send ECT packets and add the CE-marked fraction echoed by the reflector to the adaptive client's prediction", ecn);
+    cmd.AddValue("telemetry", "Publish the live state of the run in /dev/shm/masticc-<pid>.telemetry for masticc-telemetry", telemetry);
+    cmd.AddValue("telemetryInterval", "Simulated time between two updates of the telemetry page (ms)", telemetryInterval);
     cmd.Parse(argc, argv);
+    SchedulerHelper::Set(scheduler);
+    NS_ABORT_MSG_IF(evaluate && !adaptiveClient, "--evaluate needs --adaptiveClient");
+    NS_ABORT_MSG_IF(onlineLearning && !adaptiveClient, "--onlineLearning needs --adaptiveClient");
+    NS_ABORT_MSG_IF(ecn && !(adaptiveClient && reflector), "--ecn needs --adaptiveClient and --reflector");
     if (verbose) {
         LogComponentEnable("UdpEchoClientApplication", LOG_LEVEL_INFO);
         LogComponentEnable("UdpEchoServerApplication", LOG_LEVEL_INFO);
+        LogComponentEnable("EchoReflectorApplication", LOG_LEVEL_INFO);
     }
-    nClients = nClients < 2 ? 2 : nClients;
-    InternetStackHelper stack;
-    Ipv4AddressHelper address;
-
-    // client star network
-    PointToPointHelper pointToPoint;
-    pointToPoint.SetDeviceAttribute("DataRate", StringValue(std::to_string(accessRate) + "Mbps"));
-    pointToPoint.SetChannelAttribute("Delay", StringValue(std::to_string(accessDelay) + "ms"));
-    pointToPoint.SetQueue("ns3::DropTailQueue",  "MaxSize", QueueSizeValue (QueueSize ("5p")));
-    PointToPointStarHelper star(nClients, pointToPoint);
-    star.InstallStack(stack);
-    address.SetBase("192.168.0.0", "255.255.255.0");
-    star.AssignIpv4Addresses(address);
-
-    // p2p between R2 and Server
-    NodeContainer serverNodes;
-    serverNodes.Create(2);
-    NetDeviceContainer serverDevices = pointToPoint.Install(serverNodes);
-    stack.Install(serverNodes);
-    address.SetBase("10.0.2.0", "255.255.255.0");
-    Ipv4InterfaceContainer serverInterfaces = address.Assign(serverDevices);
-
-    // p2p between R1 and R2
-    NodeContainer routerNodes;
-    routerNodes.Add(star.GetHub());
-    routerNodes.Add(serverNodes.Get(0));
-    pointToPoint.SetDeviceAttribute("DataRate", StringValue(std::to_string(bottleneckRate) + "Mbps"));
-    pointToPoint.SetChannelAttribute("Delay", StringValue(std::to_string(bottleneckDelay) + "ms"));
-    NetDeviceContainer routerDevices = pointToPoint.Install(routerNodes);
-    address.SetBase("10.0.0.0", "255.255.255.252");
-    Ipv4InterfaceContainer routerInterfaces = address.Assign(routerDevices);
-    //Ptr<DropTailQueue> queue = DynamicCast<DropTailQueue>(DynamicCast<PointToPointNetDevice>(routerDevices.Get(0))->GetQueue());
-    //queue->SetAttribute ("MaxPackets", UintegerValue (3));
+    MasticcTopologyHelper topology;
+    topology.SetNClients(nClients);
+    topology.SetAccessLink(DataRate(std::to_string(accessRate) + "Mbps"), MilliSeconds(accessDelay));
+    topology.SetBottleneckLink(DataRate(std::to_string(bottleneckRate) + "Mbps"), MilliSeconds(bottleneckDelay));
+    topology.SetBottleneckQueueDisc(queueDisc);
+    topology.Install();
 
     // set up server
-    UdpEchoServerHelper echoServer(9);
-    ApplicationContainer serverApps = echoServer.Install(serverNodes.Get(1));
+    ApplicationContainer serverApps;
+    if (reflector) {
+        EchoReflectorHelper echoReflector(9);
+        echoReflector.SetAttribute("SampleEvery", UintegerValue(reflectorSample));
+        echoReflector.SetAttribute("BatchSize", UintegerValue(reflectorBatch));
+        echoReflector.SetAttribute("BatchTimeout", TimeValue(MilliSeconds(reflectorBatchTimeout)));
+        serverApps = echoReflector.Install(topology.GetServer());
+    } else {
+        UdpEchoServerHelper echoServer(9);
+        serverApps = echoServer.Install(topology.GetServer());
+    }
     serverApps.Start(Seconds(0.0));
     serverApps.Stop(Seconds(10.0));
     // set up noise client
-    RandomNoiseClientHelper noiseClient(serverInterfaces.GetAddress(1), 9);
+    RandomNoiseClientHelper noiseClient(topology.GetServerAddress(), 9);
     noiseClient.SetAttribute("IntervalMean", DoubleValue(meanNoiseInterval / 1000.));
     noiseClient.SetAttribute("PacketSizeMean", DoubleValue(meanNoiseSize));
     float stdev = meanNoiseSize * .3;
     float variance = stdev * stdev;
     noiseClient.SetAttribute("PacketSizeVariance", DoubleValue(variance));
-    ApplicationContainer noiseApps = noiseClient.Install(star.GetSpokeNode(0));
+    noiseClient.SetAttribute("TargetRate", DataRateValue(DataRate(noiseRate * 1e6)));
+    noiseClient.SetAttribute("SizeDistribution", StringValue(noiseSizes));
+    noiseClient.SetAttribute("BurstSize", UintegerValue(noiseBurst));
+    noiseClient.SetAttribute("RateProfile", StringValue(noiseProfile));
+    noiseClient.SetAttribute("ProfileRate", DataRateValue(DataRate(noiseProfileRate * 1e6)));
+    noiseClient.SetAttribute("ProfilePeriod", TimeValue(Seconds(noiseProfilePeriod)));
+    noiseClient.SetAttribute("TraceFile", StringValue(noiseTrace));
+    noiseClient.SetAttribute("TraceTimeScale", DoubleValue(noiseTraceScale));
+    ApplicationContainer noiseApps = noiseClient.Install(topology.GetClient(0));
     noiseApps.Start(Seconds(0.0));
     noiseApps.Stop(Seconds(10.0));
 
     // set up main client
-    UdpEchoClientHelper echoClient(serverInterfaces.GetAddress(1), 9);
-    echoClient.SetAttribute("MaxPackets", UintegerValue(0));
-    echoClient.SetAttribute("Interval", TimeValue(Seconds(0.1)));
-    echoClient.SetAttribute("PacketSize", UintegerValue(1024));
-    ApplicationContainer clientApps = echoClient.Install(star.GetSpokeNode(1));
+    ApplicationContainer clientApps;
+    Ptr<OnlineTrainer> trainer;
+    if (adaptiveClient) {
+        RandomNoiseClientHelper lstmClient(topology.GetServerAddress(), 9);
+        lstmClient.SetAttribute("IntervalMean", DoubleValue(0));
+        if (reflector) {
+            lstmClient.SetAttribute("Timestamps", BooleanValue(true));
+            lstmClient.SetAttribute("LatencySignal", StringValue("Forward"));
+            lstmClient.SetAttribute("EcnFeedback", BooleanValue(ecn));
+        }
+        if (onlineLearning) {
+            trainer = CreateObject<OnlineTrainer>();
+            // worker threads do not survive the forks of replications and variants
+            trainer->SetAttribute("Synchronous", BooleanValue(warmup > 0 || replications > 1));
+            trainer->SetBottleneck(topology.GetBottleneckDevice());
+            lstmClient.SetAttribute("OnlineTrainer", PointerValue(trainer));
+        }
+        clientApps = lstmClient.Install(topology.GetClient(1));
+    } else {
+        UdpEchoClientHelper echoClient(topology.GetServerAddress(), 9);
+        echoClient.SetAttribute("MaxPackets", UintegerValue(0));
+        echoClient.SetAttribute("Interval", TimeValue(Seconds(0.1)));
+        echoClient.SetAttribute("PacketSize", UintegerValue(1024));
+        clientApps = echoClient.Install(topology.GetClient(1));
+    }
     clientApps.Start(Seconds(0.0));
     clientApps.Stop(Seconds(10.0));
 
     // Flow monitor
+    // probes only classify packets at the node that sends them, so probes on
+    // the routers alone see nothing; "endpoints" skips the per-hop probes
     Ptr<FlowMonitor> flowMonitor;
     FlowMonitorHelper flowHelper;
-    flowMonitor = flowHelper.InstallAll();
-    //flowMonitor = flowHelper.Install(routerNodes);
+    if (flowMonitorScope == "all") {
+        flowMonitor = flowHelper.InstallAll();
+    } else if (flowMonitorScope == "endpoints") {
+        NodeContainer endpoints;
+        endpoints.Add(topology.GetClient(0));
+        endpoints.Add(topology.GetClient(1));
+        endpoints.Add(topology.GetServer());
+        flowMonitor = flowHelper.Install(endpoints);
+    } else if (flowMonitorScope != "none") {
+        NS_FATAL_ERROR("Unknown flowMonitorScope " << flowMonitorScope);
+    }
+    struct FlowTotals {
+        uint64_t rxBytes = 0;
+        uint64_t rxPackets = 0;
+        uint64_t txPackets = 0;
+        uint64_t lostPackets = 0;
+        Time delaySum;
+        Time jitterSum;
+    };
+    auto flowTotals = [&]() {
+        FlowTotals totals;
+        flowMonitor->CheckForLostPackets();
+        for (const auto& [flowId, stats] : flowMonitor->GetFlowStats()) {
+            totals.rxBytes += stats.rxBytes;
+            totals.rxPackets += stats.rxPackets;
+            totals.txPackets += stats.txPackets;
+            totals.lostPackets += stats.lostPackets;
+            totals.delaySum += stats.delaySum;
+            totals.jitterSum += stats.jitterSum;
+        }
+        return totals;
+    };
 
-    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
-    pointToPoint.EnablePcap("traces/client.pcap", star.GetSpokeNode(1) -> GetDevice(0), false, true);
-    // pointToPoint.EnablePcap("traces/router1.pcap", star.GetHub() -> GetDevice(1), false, true);
-    pointToPoint.EnablePcap("traces/router1.pcap", serverDevices.Get(0), false, true);
-    pointToPoint.EnablePcap("traces/router2.pcap", serverDevices.Get(0), false, true);
-    //pointToPoint.EnablePcapAll("traces/ppp");
+    // everything from here writes output or runs the simulation, once per replication
+    auto runScenario = [&](std::string traces, double* metrics) {
+        Time start = Simulator::Now();
+        FlowTotals before;
+        if (metrics && flowMonitor) {
+            before = flowTotals();
+        }
+        Ptr<FlowStatsSampler> flowSampler;
+        if (flowMonitor && flowSampleInterval > 0) {
+            flowSampler = CreateObject<FlowStatsSampler>();
+            flowSampler->SetAttribute("Interval", TimeValue(MilliSeconds(flowSampleInterval)));
+            flowSampler->SetAttribute("OutputFile", StringValue(traces + "flows.csv"));
+            flowSampler->SetFlowMonitor(flowMonitor, DynamicCast<Ipv4FlowClassifier>(flowHelper.GetClassifier()));
+            flowSampler->Start();
+        }
 
-    Simulator::Stop(Seconds(15));
-    Simulator::Run();
-    Simulator::Destroy();
+        Ptr<AdaptiveClientEvaluator> evaluator;
+        if (evaluate) {
+            evaluator = CreateObject<AdaptiveClientEvaluator>();
+            evaluator->SetAttribute("OutputFile", StringValue(traces + "evaluation.csv"));
+            evaluator->SetClient(DynamicCast<RandomNoiseClient>(clientApps.Get(0)), topology.GetClientAddress(1));
+            evaluator->SetBottleneck(topology.GetBottleneckDevice());
+            evaluator->AddNoiseSource(noiseApps.Get(0));
+            evaluator->Start();
+            Simulator::Schedule(Seconds(10) - Simulator::Now(), &AdaptiveClientEvaluator::Stop, evaluator);
+        }
+
+        // created in every replication and variant, so each process has its own page
+        Ptr<TelemetryPage> telemetryPage;
+        if (telemetry) {
+            telemetryPage = CreateObject<TelemetryPage>();
+            telemetryPage->SetAttribute("Interval", TimeValue(MilliSeconds(telemetryInterval)));
+            telemetryPage->AddClients(noiseApps);
+            telemetryPage->AddClients(clientApps);
+            telemetryPage->Start();
+            std::cout << "telemetry page " << telemetryPage->GetFile() << "\n";
+        }
+
+        // router1 is the capture of the bottleneck traffic towards the server
+        if (traceMode == "pcap") {
+            PointToPointHelper pointToPoint;
+            pointToPoint.EnablePcap(traces + "client.pcap", topology.GetClientDevice(1), false, true);
+            // pointToPoint.EnablePcap(traces + "router1.pcap", topology.GetBottleneckDevice(), false, true);
+            pointToPoint.EnablePcap(traces + "router1.pcap", topology.GetServerLinkDevice(), false, true);
+            //pointToPoint.EnablePcapAll(traces + "ppp");
+        } else if (traceMode == "summary") {
+            HeaderSummaryHelper summary;
+            summary.SetByteBudget(traceBudget);
+            summary.SetSnapLen(traceSnapLen);
+            summary.Enable(traces + "client.mhs", topology.GetClientDevice(1));
+            summary.Enable(traces + "router1.mhs", topology.GetServerLinkDevice());
+        } else if (traceMode != "none") {
+            NS_FATAL_ERROR("Unknown traceMode " << traceMode);
+        }
+
+        Simulator::Stop(Seconds(15) - Simulator::Now());
+        Simulator::Run();
+        if (flowSampler) {
+            flowSampler->Stop();
+        }
+        if (telemetryPage) {
+            telemetryPage->Stop();
+        }
+        if (evaluator) {
+            evaluator->Print(std::cout);
+        }
+        if (Ptr<QueueDisc> bottleneckQueue = topology.GetBottleneckQueueDisc()) {
+            const QueueDisc::Stats& stats = bottleneckQueue->GetStats();
+            std::cout << queueDisc << " bottleneck: " << stats.nTotalMarkedPackets << " packets marked, "
+                      << stats.nTotalDroppedPackets << " dropped\n";
+        }
+        if (trainer) {
+            std::cout << "online learning: " << trainer->GetSteps() << " output layer updates\n";
+        }
+        if (memoryReport) {
+            ApplicationContainer randomNoiseClients(noiseApps);
+            randomNoiseClients.Add(clientApps);
+            RandomNoiseClientHelper::PrintMemoryUsage(randomNoiseClients, std::cout);
+        }
+        if (metrics && flowMonitor) {
+            // goodput while the applications run, delay, jitter and loss of all flows
+            FlowTotals after = flowTotals();
+            uint64_t rxPackets = after.rxPackets - before.rxPackets;
+            uint64_t txPackets = after.txPackets - before.txPackets;
+            metrics[0] = (after.rxBytes - before.rxBytes) * 8 / (10. - start.GetSeconds()) / 1e6;
+            metrics[1] = rxPackets > 0 ? (after.delaySum - before.delaySum).GetSeconds() * 1e3 / rxPackets : 0;
+            metrics[2] = rxPackets > 0 ? (after.jitterSum - before.jitterSum).GetSeconds() * 1e3 / rxPackets : 0;
+            metrics[3] = txPackets > 0 ? static_cast<double>(after.lostPackets - before.lostPackets) / txPackets : 0;
+        }
+        Simulator::Destroy();
+    };
+
+    ReplicationHelper replication;
+    replication.AddMetric("goodput (Mbps)");
+    replication.AddMetric("delay (ms)");
+    replication.AddMetric("jitter (ms)");
+    replication.AddMetric("loss ratio");
+    if (warmup > 0) {
+        // ns-3 cannot serialize a running simulation, so the snapshot is the
+        // process itself: simulate the warm-up once, then fork one branch per
+        // variant. Queues, in-flight packets, RNG stream positions and the
+        // LSTM windows all carry over; traces cover the branches only.
+        NS_ABORT_MSG_IF(replications > 1, "--warmup and --replications cannot be combined");
+        NS_ABORT_MSG_IF(warmup >= 10, "The applications stop at 10 s, the warm-up must end before");
+        std::vector<std::pair<double, std::string>> branches;
+        std::istringstream list(variants);
+        std::string variant;
+        while (std::getline(list, variant, ',')) {
+            size_t colon = variant.find(':');
+            branches.emplace_back(std::stod(variant.substr(0, colon)),
+                                  colon == std::string::npos ? "" : variant.substr(colon + 1));
+        }
+        NS_ABORT_MSG_IF(branches.empty(), "--warmup needs at least one variant");
+        NS_ABORT_MSG_UNLESS(adaptiveClient, "Variants change the adaptive client, use --adaptiveClient");
+        Simulator::Stop(Seconds(warmup));
+        Simulator::Run();
+
+        Ptr<Application> lstmClient = clientApps.Get(0);
+        replication.SetReplications(branches.size());
+        replication.SetJobs(jobs);
+        replication.SetIndependentRuns(false);
+        replication.Run([&](uint32_t i, double* metrics) {
+            lstmClient->SetAttribute("PacingExponent", DoubleValue(branches[i].first));
+            if (!branches[i].second.empty()) {
+                lstmClient->SetAttribute("ModelFile", StringValue(branches[i].second));
+            }
+            std::string traces = "traces/variant" + std::to_string(i) + "/";
+            SystemPath::MakeDirectories(traces);
+            runScenario(traces, metrics);
+        });
+        for (uint32_t i = 0; i < branches.size(); i++) {
+            std::cout << "variant " << i << " (exponent " << branches[i].first;
+            if (!branches[i].second.empty()) {
+                std::cout << ", model " << branches[i].second;
+            }
+            std::cout << "):";
+            if (!replication.IsCompleted(i)) {
+                std::cout << " did not complete\n";
+                continue;
+            }
+            std::cout << " goodput " << replication.GetValue(i, 0) << " Mbps, delay "
+                      << replication.GetValue(i, 1) << " ms, jitter " << replication.GetValue(i, 2)
+                      << " ms, loss " << replication.GetValue(i, 3) << "\n";
+        }
+        Simulator::Destroy();
+    } else if (replications <= 1) {
+        runScenario("traces/", nullptr);
+    } else {
+        // topology, routing and applications are built once and shared
+        // copy-on-write by the workers, which only redraw their random streams
+        replication.SetReplications(replications);
+        replication.SetJobs(jobs);
+        replication.Run([&](uint32_t, double* metrics) {
+            noiseClient.AssignStreams(NodeContainer(topology.GetClient(0)), 0);
+            std::string traces = "traces/run" + std::to_string(RngSeedManager::GetRun()) + "/";
+            SystemPath::MakeDirectories(traces);
+            runScenario(traces, metrics);
+        });
+        replication.Print(std::cout);
+        Simulator::Destroy();
+    }
     return 0;
 }
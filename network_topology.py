@@ -7,6 +7,12 @@
 #           /      10.0.0.0        10.0.2.0
 #          / .2.0
 #         C2
+#
+# With --server=True the process stays warm and reads one JSON scenario per line
+# from stdin, e.g. {"bottleneckRate": 10, "noiseInterval": 0.05, "pcap": ""},
+# answering each with one JSON line of results on stdout; anything else the
+# simulation prints goes to stderr. Missing keys take the values of DEFAULTS,
+# so a sweep pays the cppyy start-up only once.
 
 
 try:
@@ -17,102 +23,229 @@ except ModuleNotFoundError:
         " Python bindings may not be enabled"
         " or your PYTHONPATH might not be properly configured"
     )
+import json
+import os
 import sys
+import time
 from ctypes import c_bool, c_int
 
-# command line arguments
-nClients = c_int(3)
-accessRate = c_int(1024)  # Mbps
-accessDelay = c_int(5)  # ms
-bottleneckRate = c_int(5)  # Mbps
-bottleneckDelay = c_int(10)  # ms
-verbose = c_bool(True)
-cmd = ns.CommandLine(__file__)
-cmd.AddValue("nClients", "Number of clients connected to R1", nClients)
-cmd.AddValue("accessRate", "Rate of access links (Mbps)", accessRate)
-cmd.AddValue("accessDelay", "Delay of access links (ms)", accessDelay)
-cmd.AddValue("bottleneckRate", "Rate of access links (Mbps)", bottleneckRate)
-cmd.AddValue("bottleneckDelay", "Delay of access links (ms)", bottleneckDelay)
-cmd.AddValue("verbose", "Tell echo applications to log if true", verbose)
-cmd.Parse(sys.argv)
-
-# logging
-if verbose.value:
-    ns.core.LogComponentEnable("UdpEchoClientApplication", ns.core.LOG_LEVEL_INFO)
-    ns.core.LogComponentEnable("UdpEchoServerApplication", ns.core.LOG_LEVEL_INFO)
-
-# helpers
-stack = ns.internet.InternetStackHelper()
-address = ns.internet.Ipv4AddressHelper()
-pointToPoint = ns.point_to_point.PointToPointHelper()
-
-# client star network
-pointToPoint.SetDeviceAttribute("DataRate", ns.core.StringValue(f"{accessRate.value}Mbps"))
-pointToPoint.SetChannelAttribute("Delay", ns.core.StringValue(f"{accessDelay.value}ms"))
-star = ns.point_to_point.PointToPointStarHelper(nClients.value, pointToPoint)
-star.InstallStack(stack)
-address.SetBase(ns.network.Ipv4Address("192.168.0.0"), ns.network.Ipv4Mask("255.255.255.0"))
-star.AssignIpv4Addresses(address)
-
-# point-to-point between R2 and Server
-serverNodes = ns.network.NodeContainer()
-serverNodes.Create(2)
-serverDevices = pointToPoint.Install(serverNodes)
-stack.Install(serverNodes)
-address.SetBase(ns.network.Ipv4Address("10.0.2.0"), ns.network.Ipv4Mask("255.255.255.0"))
-serverInterfaces = address.Assign(serverDevices)
-
-# point-to-point between R1 and R2
-routerNodes = ns.network.NodeContainer()
-routerNodes.Add(star.GetHub())
-routerNodes.Add(serverNodes.Get(0))
-pointToPoint.SetDeviceAttribute("DataRate", ns.core.StringValue(f"{bottleneckRate.value}Mbps"))
-pointToPoint.SetChannelAttribute("Delay", ns.core.StringValue(f"{bottleneckDelay.value}ms"))
-routerDevices = pointToPoint.Install(routerNodes)
-address.SetBase(ns.network.Ipv4Address("10.0.0.0"), ns.network.Ipv4Mask("255.255.255.252"))
-routerInterfaces = address.Assign(routerDevices)
-
-# set up server
-echoServer = ns.applications.UdpEchoServerHelper(9)
-serverApps = echoServer.Install(serverNodes.Get(1))
-serverApps.Start(ns.core.Seconds(1.0))
-serverApps.Stop(ns.core.Seconds(10.0))
-
-# set up noise client
-noiseClient = ns.applications.RandomNoiseClientHelper(serverInterfaces.GetAddress(1).ConvertTo(), 9)
-noiseClient.SetAttribute("IntervalMean", ns.core.DoubleValue(0.1))
-noiseClient.SetAttribute("PacketSizeMean", ns.core.DoubleValue(1024.0))
-noiseClient.SetAttribute("PacketSizeVariance", ns.core.DoubleValue(1024.0))
-noiseApps = noiseClient.Install(star.GetSpokeNode(1))
-noiseApps.Start(ns.core.Seconds(2.0))
-noiseApps.Stop(ns.core.Seconds(10.0))
-
-
-# set up main client
-echoClient = ns.applications.UdpEchoClientHelper(serverInterfaces.GetAddress(1).ConvertTo(), 9)
-echoClient.SetAttribute("MaxPackets", ns.core.UintegerValue(1))
-echoClient.SetAttribute("Interval", ns.core.TimeValue(ns.core.Seconds(1.)))
-echoClient.SetAttribute("PacketSize", ns.core.UintegerValue(1024))
-clientApps = echoClient.Install(star.GetSpokeNode(0))
-clientApps.Start(ns.core.Seconds(2.0))
-clientApps.Stop(ns.core.Seconds(10.0))
-
-# routing
-ns.internet.Ipv4GlobalRoutingHelper.PopulateRoutingTables()
-
-# tracing
-pointToPoint.EnablePcapAll("masticc/traces/network_topology")
-
-# log all IP addresses
-print()
-for i in range(nClients.value):
-    print(f"Client{i} {star.GetSpokeIpv4Address(i)} --- {star.GetHubIpv4Address(i)} Router1")
-print()
-print(f"Router1 {routerInterfaces.GetAddress(0)} --- {routerInterfaces.GetAddress(1)} Router2")
-print()
-print(f"Router2 {serverInterfaces.GetAddress(0)} --- {serverInterfaces.GetAddress(1)} Server")
-print()
-
-# simulation
-ns.core.Simulator.Run()
-ns.core.Simulator.Destroy()
+import cppyy
+
+DEFAULTS = {
+    "nClients": 3,
+    "accessRate": 1024,  # Mbps
+    "accessDelay": 5,  # ms
+    "bottleneckRate": 5,  # Mbps
+    "bottleneckDelay": 10,  # ms
+    "verbose": True,
+    "noiseInterval": 0.1,  # s
+    "noiseSize": 1024.0,  # bytes
+    "noiseSizeVariance": 1024.0,
+    "stopTime": 10.0,  # s
+    "seed": 1,
+    "run": 1,
+    "pcap": "masticc/traces/network_topology",
+}
+
+
+def load_dictionary():
+    """Loads the precompiled random_noise_client dictionary when it was built
+    (-DMASTICC_PYTHON_DICTIONARY=ON); MASTICC_DICTIONARY overrides its path."""
+    path = os.environ.get("MASTICC_DICTIONARY")
+    if path is None:
+        package = os.path.dirname(sys.modules["ns"].__file__)
+        path = os.path.join(package, "..", "..", "..", "lib", "libmasticc_dict.so")
+    if os.path.exists(path):
+        cppyy.load_reflection_info(path)
+        return True
+    return False
+
+
+def run_scenario(config, log_addresses=False, collect=False):
+    """Builds the topology of one scenario, simulates it and tears it down again
+    so that the next scenario starts from a clean simulator."""
+    start = time.perf_counter()
+    ns.core.RngSeedManager.SetSeed(config["seed"])
+    ns.core.RngSeedManager.SetRun(config["run"])
+    stopTime = config["stopTime"]
+
+    # logging
+    for component in ("UdpEchoClientApplication", "UdpEchoServerApplication"):
+        if config["verbose"]:
+            ns.core.LogComponentEnable(component, ns.core.LOG_LEVEL_INFO)
+        else:
+            ns.core.LogComponentDisable(component, ns.core.LOG_LEVEL_INFO)
+
+    # helpers
+    stack = ns.internet.InternetStackHelper()
+    address = ns.internet.Ipv4AddressHelper()
+    pointToPoint = ns.point_to_point.PointToPointHelper()
+
+    # client star network
+    pointToPoint.SetDeviceAttribute("DataRate", ns.core.StringValue(f"{config['accessRate']}Mbps"))
+    pointToPoint.SetChannelAttribute("Delay", ns.core.StringValue(f"{config['accessDelay']}ms"))
+    star = ns.point_to_point.PointToPointStarHelper(config["nClients"], pointToPoint)
+    star.InstallStack(stack)
+    address.SetBase(ns.network.Ipv4Address("192.168.0.0"), ns.network.Ipv4Mask("255.255.255.0"))
+    star.AssignIpv4Addresses(address)
+
+    # point-to-point between R2 and Server
+    serverNodes = ns.network.NodeContainer()
+    serverNodes.Create(2)
+    serverDevices = pointToPoint.Install(serverNodes)
+    stack.Install(serverNodes)
+    address.SetBase(ns.network.Ipv4Address("10.0.2.0"), ns.network.Ipv4Mask("255.255.255.0"))
+    serverInterfaces = address.Assign(serverDevices)
+
+    # point-to-point between R1 and R2
+    routerNodes = ns.network.NodeContainer()
+    routerNodes.Add(star.GetHub())
+    routerNodes.Add(serverNodes.Get(0))
+    pointToPoint.SetDeviceAttribute("DataRate", ns.core.StringValue(f"{config['bottleneckRate']}Mbps"))
+    pointToPoint.SetChannelAttribute("Delay", ns.core.StringValue(f"{config['bottleneckDelay']}ms"))
+    routerDevices = pointToPoint.Install(routerNodes)
+    address.SetBase(ns.network.Ipv4Address("10.0.0.0"), ns.network.Ipv4Mask("255.255.255.252"))
+    routerInterfaces = address.Assign(routerDevices)
+
+    # set up server
+    echoServer = ns.applications.UdpEchoServerHelper(9)
+    serverApps = echoServer.Install(serverNodes.Get(1))
+    serverApps.Start(ns.core.Seconds(1.0))
+    serverApps.Stop(ns.core.Seconds(stopTime))
+
+    # set up noise client
+    noiseClient = ns.applications.RandomNoiseClientHelper(serverInterfaces.GetAddress(1).ConvertTo(), 9)
+    noiseClient.SetAttribute("IntervalMean", ns.core.DoubleValue(config["noiseInterval"]))
+    noiseClient.SetAttribute("PacketSizeMean", ns.core.DoubleValue(config["noiseSize"]))
+    noiseClient.SetAttribute("PacketSizeVariance", ns.core.DoubleValue(config["noiseSizeVariance"]))
+    noiseApps = noiseClient.Install(star.GetSpokeNode(1))
+    noiseApps.Start(ns.core.Seconds(2.0))
+    noiseApps.Stop(ns.core.Seconds(stopTime))
+
+    # set up main client
+    echoClient = ns.applications.UdpEchoClientHelper(serverInterfaces.GetAddress(1).ConvertTo(), 9)
+    echoClient.SetAttribute("MaxPackets", ns.core.UintegerValue(1))
+    echoClient.SetAttribute("Interval", ns.core.TimeValue(ns.core.Seconds(1.)))
+    echoClient.SetAttribute("PacketSize", ns.core.UintegerValue(1024))
+    clientApps = echoClient.Install(star.GetSpokeNode(0))
+    clientApps.Start(ns.core.Seconds(2.0))
+    clientApps.Stop(ns.core.Seconds(stopTime))
+
+    # routing
+    ns.internet.Ipv4GlobalRoutingHelper.PopulateRoutingTables()
+
+    # tracing
+    if config["pcap"]:
+        pointToPoint.EnablePcapAll(config["pcap"])
+    if collect:
+        flowmonHelper = ns.flow_monitor.FlowMonitorHelper()
+        monitor = flowmonHelper.InstallAll()
+
+    # log all IP addresses
+    if log_addresses:
+        print()
+        for i in range(config["nClients"]):
+            print(f"Client{i} {star.GetSpokeIpv4Address(i)} --- {star.GetHubIpv4Address(i)} Router1")
+        print()
+        print(f"Router1 {routerInterfaces.GetAddress(0)} --- {routerInterfaces.GetAddress(1)} Router2")
+        print()
+        print(f"Router2 {serverInterfaces.GetAddress(0)} --- {serverInterfaces.GetAddress(1)} Server")
+        print()
+
+    # simulation
+    built = time.perf_counter()
+    ns.core.Simulator.Stop(ns.core.Seconds(stopTime))
+    ns.core.Simulator.Run()
+    result = {
+        "setupSeconds": built - start,
+        "wallSeconds": time.perf_counter() - built,
+        "events": ns.core.Simulator.GetEventCount(),
+    }
+    if collect:
+        monitor.CheckForLostPackets()
+        flows = []
+        for flowId, stats in monitor.GetFlowStats():
+            flows.append({
+                "flow": flowId,
+                "txPackets": stats.txPackets,
+                "rxPackets": stats.rxPackets,
+                "lostPackets": stats.lostPackets,
+                "rxBytes": stats.rxBytes,
+                "meanDelay": stats.delaySum.GetSeconds() / stats.rxPackets if stats.rxPackets else None,
+            })
+        result["flows"] = flows
+    ns.core.Simulator.Destroy()
+    # addresses are handed out by a global generator that outlives the simulator
+    ns.internet.Ipv4AddressGenerator.Reset()
+    return result
+
+
+def serve(config):
+    """Runs every JSON scenario read from stdin on top of config and writes one
+    JSON result per line; the optional "id" of a request is echoed back."""
+    # results go to a duplicate of stdout and file descriptor 1 is pointed at
+    # stderr, so whatever the simulation prints (Python, C++ std::cout or
+    # printf) cannot end up between the result lines
+    sys.stdout.flush()
+    cppyy.gbl.std.cout.flush()
+    results = os.fdopen(os.dup(sys.stdout.fileno()), "w")
+    os.dup2(sys.stderr.fileno(), sys.stdout.fileno())
+    for line in sys.stdin:
+        line = line.strip()
+        if not line:
+            continue
+        request = None
+        try:
+            request = json.loads(line)
+            if not isinstance(request, dict):
+                raise ValueError("a scenario must be a JSON object")
+            scenario = dict(config)
+            scenario.update({k: v for k, v in request.items() if k != "id"})
+            unknown = set(scenario) - set(DEFAULTS)
+            if unknown:
+                raise ValueError(f"unknown keys {sorted(unknown)}")
+            result = run_scenario(scenario, collect=True)
+        except (ValueError, TypeError) as error:
+            result = {"error": str(error)}
+        if isinstance(request, dict) and "id" in request:
+            result["id"] = request["id"]
+        print(json.dumps(result), file=results, flush=True)
+
+
+def main():
+    # command line arguments
+    nClients = c_int(DEFAULTS["nClients"])
+    accessRate = c_int(DEFAULTS["accessRate"])
+    accessDelay = c_int(DEFAULTS["accessDelay"])
+    bottleneckRate = c_int(DEFAULTS["bottleneckRate"])
+    bottleneckDelay = c_int(DEFAULTS["bottleneckDelay"])
+    verbose = c_bool(DEFAULTS["verbose"])
+    server = c_bool(False)
+    cmd = ns.CommandLine(__file__)
+    cmd.AddValue("nClients", "Number of clients connected to R1", nClients)
+    cmd.AddValue("accessRate", "Rate of access links (Mbps)", accessRate)
+    cmd.AddValue("accessDelay", "Delay of access links (ms)", accessDelay)
+    cmd.AddValue("bottleneckRate", "Rate of access links (Mbps)", bottleneckRate)
+    cmd.AddValue("bottleneckDelay", "Delay of access links (ms)", bottleneckDelay)
+    cmd.AddValue("verbose", "Tell echo applications to log if true", verbose)
+    cmd.AddValue("server", "Read JSON scenarios from stdin until EOF, one result line each", server)
+    cmd.Parse(sys.argv)
+
+    load_dictionary()
+    config = dict(DEFAULTS)
+    config.update({
+        "nClients": nClients.value,
+        "accessRate": accessRate.value,
+        "accessDelay": accessDelay.value,
+        "bottleneckRate": bottleneckRate.value,
+        "bottleneckDelay": bottleneckDelay.value,
+        "verbose": verbose.value,
+    })
+    if server.value:
+        serve(config)
+    else:
+        run_scenario(config, log_addresses=True)
+
+
+if __name__ == "__main__":
+    main()
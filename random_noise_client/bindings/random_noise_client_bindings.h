@@ -0,0 +1,42 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef RANDOM_NOISE_CLIENT_BINDINGS_H
+#define RANDOM_NOISE_CLIENT_BINDINGS_H
+
+/**
+ * \file
+ * \ingroup randomnoise
+ * Headers compiled into the cppyy dictionary of the random_noise_client
+ * module (see selection.xml and the MASTICC_PYTHON_DICTIONARY option).
+ */
+
+#include "ns3/adaptive_client_evaluator.h"
+#include "ns3/echo_reflector.h"
+#include "ns3/echo_reflector_helper.h"
+#include "ns3/echo_timestamp_header.h"
+#include "ns3/flow_stats_sampler.h"
+#include "ns3/header_summary_helper.h"
+#include "ns3/lstm_predictor.h"
+#include "ns3/masticc_topology_helper.h"
+#include "ns3/online_trainer.h"
+#include "ns3/random_noise_client.h"
+#include "ns3/random_noise_client_helper.h"
+#include "ns3/replication_helper.h"
+#include "ns3/scheduler_helper.h"
+#include "ns3/telemetry_page.h"
+#include "ns3/timing_wheel_scheduler.h"
+
+#endif /* RANDOM_NOISE_CLIENT_BINDINGS_H */
@@ -0,0 +1,69 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "echo_reflector_helper.h"
+
+#include "ns3/echo_reflector.h"
+#include "ns3/names.h"
+#include "ns3/uinteger.h"
+
+namespace ns3
+{
+
+EchoReflectorHelper::EchoReflectorHelper(uint16_t port)
+{
+    m_factory.SetTypeId(EchoReflector::GetTypeId());
+    SetAttribute("Port", UintegerValue(port));
+}
+
+void
+EchoReflectorHelper::SetAttribute(std::string name, const AttributeValue& value)
+{
+    m_factory.Set(name, value);
+}
+
+ApplicationContainer
+EchoReflectorHelper::Install(Ptr<Node> node) const
+{
+    return ApplicationContainer(InstallPriv(node));
+}
+
+ApplicationContainer
+EchoReflectorHelper::Install(std::string nodeName) const
+{
+    Ptr<Node> node = Names::Find<Node>(nodeName);
+    return ApplicationContainer(InstallPriv(node));
+}
+
+ApplicationContainer
+EchoReflectorHelper::Install(NodeContainer c) const
+{
+    ApplicationContainer apps;
+    for (auto i = c.Begin(); i != c.End(); ++i)
+    {
+        apps.Add(InstallPriv(*i));
+    }
+    return apps;
+}
+
+Ptr<Application>
+EchoReflectorHelper::InstallPriv(Ptr<Node> node) const
+{
+    Ptr<Application> app = m_factory.Create<EchoReflector>();
+    node->AddApplication(app);
+    return app;
+}
+
+} // namespace ns3
@@ -0,0 +1,79 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ECHO_REFLECTOR_HELPER_H
+#define ECHO_REFLECTOR_HELPER_H
+
+#include "ns3/application-container.h"
+#include "ns3/node-container.h"
+#include "ns3/object-factory.h"
+
+#include <stdint.h>
+#include <string>
+
+namespace ns3
+{
+
+/**
+ * \ingroup randomnoise
+ * \brief Create EchoReflector applications, the timestamping counterpart of
+ * UdpEchoServerHelper.
+ */
+class EchoReflectorHelper
+{
+  public:
+    /**
+     * \param port the port the reflector listens on
+     */
+    EchoReflectorHelper(uint16_t port);
+
+    /**
+     * Record an attribute to be set in each Application after it is is created.
+     *
+     * \param name the name of the attribute to set
+     * \param value the value of the attribute to set
+     */
+    void SetAttribute(std::string name, const AttributeValue& value);
+
+    /**
+     * \param node the node on which to create the reflector
+     * \returns the application created
+     */
+    ApplicationContainer Install(Ptr<Node> node) const;
+
+    /**
+     * \param nodeName name of the node, registered with the Object Name Service
+     * \returns the application created
+     */
+    ApplicationContainer Install(std::string nodeName) const;
+
+    /**
+     * \param c the nodes
+     * \returns the applications created, one application per input node.
+     */
+    ApplicationContainer Install(NodeContainer c) const;
+
+  private:
+    /**
+     * \param node the node on which to create the reflector
+     * \returns the application installed
+     */
+    Ptr<Application> InstallPriv(Ptr<Node> node) const;
+    ObjectFactory m_factory; //!< Object factory.
+};
+
+} // namespace ns3
+
+#endif /* ECHO_REFLECTOR_HELPER_H */
@@ -0,0 +1,54 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "header_summary_helper.h"
+
+#include "ns3/abort.h"
+#include "ns3/callback.h"
+#include "ns3/simulator.h"
+
+namespace ns3
+{
+
+HeaderSummaryHelper::HeaderSummaryHelper()
+    : m_byteBudget(0),
+      m_snapLen(0)
+{
+}
+
+void
+HeaderSummaryHelper::SetByteBudget(uint64_t bytes)
+{
+    m_byteBudget = bytes;
+}
+
+void
+HeaderSummaryHelper::SetSnapLen(uint32_t snapLen)
+{
+    m_snapLen = snapLen;
+}
+
+Ptr<HeaderSummaryWriter>
+HeaderSummaryHelper::Enable(std::string filename, Ptr<NetDevice> device) const
+{
+    Ptr<HeaderSummaryWriter> writer = Create<HeaderSummaryWriter>(filename, m_byteBudget, m_snapLen);
+    bool connected = device->TraceConnectWithoutContext(
+        "PromiscSniffer",
+        MakeCallback(&HeaderSummaryWriter::Write, writer));
+    NS_ABORT_MSG_UNLESS(connected, "Device has no PromiscSniffer trace source");
+    Simulator::ScheduleDestroy(&HeaderSummaryWriter::Close, writer);
+    return writer;
+}
+
+} // namespace ns3
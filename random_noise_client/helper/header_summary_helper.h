@@ -0,0 +1,71 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef HEADER_SUMMARY_HELPER_H
+#define HEADER_SUMMARY_HELPER_H
+
+#include "ns3/header_summary.h"
+#include "ns3/net-device.h"
+
+#include <stdint.h>
+#include <string>
+
+namespace ns3
+{
+
+/**
+ * \ingroup randomnoise
+ * \brief Capture header summaries instead of full pcaps.
+ *
+ * Records only what the latency analysis needs (time stamp, IP id, source and
+ * length) in a fixed-size binary record per packet, optionally bounded by a
+ * byte budget per device. Files are closed when the simulator is destroyed.
+ */
+class HeaderSummaryHelper
+{
+  public:
+    HeaderSummaryHelper();
+
+    /**
+     * \brief Bound the size of each capture; older records are overwritten.
+     * \param bytes record bytes per device, 0 for no limit
+     */
+    void SetByteBudget(uint64_t bytes);
+
+    /**
+     * \brief Keep the first bytes of every packet after its summary.
+     * \param snapLen packet bytes to keep, starting at the IPv4 header
+     */
+    void SetSnapLen(uint32_t snapLen);
+
+    /**
+     * \brief Capture the packets sent and received by a device.
+     *
+     * Uses the PromiscSniffer trace source, like promiscuous pcap captures
+     * of point-to-point devices.
+     *
+     * \param filename the capture file
+     * \param device the device to capture on
+     * \returns the writer of the capture
+     */
+    Ptr<HeaderSummaryWriter> Enable(std::string filename, Ptr<NetDevice> device) const;
+
+  private:
+    uint64_t m_byteBudget; //!< Record bytes per device, 0 for no limit
+    uint32_t m_snapLen;    //!< Packet bytes kept per record
+};
+
+} // namespace ns3
+
+#endif /* HEADER_SUMMARY_HELPER_H */
@@ -0,0 +1,221 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "masticc_topology_helper.h"
+
+#include "ns3/abort.h"
+#include "ns3/boolean.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/ipv4-interface-container.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/point-to-point-star.h"
+#include "ns3/queue.h"
+#include "ns3/traffic-control-helper.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+MasticcTopologyHelper::MasticcTopologyHelper()
+    : m_nClients(2),
+      m_accessRate("1024Mbps"),
+      m_accessDelay(MilliSeconds(5)),
+      m_bottleneckRate("1Mbps"),
+      m_bottleneckDelay(MilliSeconds(10)),
+      m_queueSize("5p"),
+      m_queueDisc("None")
+{
+}
+
+void
+MasticcTopologyHelper::SetNClients(uint32_t nClients)
+{
+    m_nClients = std::max<uint32_t>(nClients, 2);
+}
+
+void
+MasticcTopologyHelper::SetAccessLink(DataRate rate, Time delay)
+{
+    m_accessRate = rate;
+    m_accessDelay = delay;
+}
+
+void
+MasticcTopologyHelper::SetBottleneckLink(DataRate rate, Time delay)
+{
+    m_bottleneckRate = rate;
+    m_bottleneckDelay = delay;
+}
+
+void
+MasticcTopologyHelper::SetQueueSize(QueueSize size)
+{
+    m_queueSize = size;
+}
+
+void
+MasticcTopologyHelper::SetBottleneckQueueDisc(const std::string& type)
+{
+    NS_ABORT_MSG_UNLESS(type == "None" || type == "DropTail" || type == "Red" || type == "CoDel",
+                        "Unknown bottleneck queue disc "
+                            << type << ", expected None, DropTail, Red or CoDel");
+    m_queueDisc = type;
+}
+
+void
+MasticcTopologyHelper::Install()
+{
+    NS_ABORT_MSG_IF(m_server, "MasticcTopologyHelper::Install() called twice");
+    InternetStackHelper stack;
+    Ipv4AddressHelper address;
+
+    // client star network
+    PointToPointHelper pointToPoint;
+    pointToPoint.SetDeviceAttribute("DataRate", DataRateValue(m_accessRate));
+    pointToPoint.SetChannelAttribute("Delay", TimeValue(m_accessDelay));
+    pointToPoint.SetQueue("ns3::DropTailQueue", "MaxSize", QueueSizeValue(m_queueSize));
+    PointToPointStarHelper star(m_nClients, pointToPoint);
+    star.InstallStack(stack);
+    address.SetBase("192.168.0.0", "255.255.255.0");
+    star.AssignIpv4Addresses(address);
+    for (uint32_t i = 0; i < m_nClients; i++)
+    {
+        m_clients.Add(star.GetSpokeNode(i));
+        m_clientDevices.Add(star.GetSpokeNode(i)->GetDevice(0));
+        m_clientAddresses.push_back(star.GetSpokeIpv4Address(i));
+    }
+
+    // p2p between R2 and Server
+    NodeContainer serverNodes;
+    serverNodes.Create(2);
+    m_serverDevices = pointToPoint.Install(serverNodes);
+    stack.Install(serverNodes);
+    address.SetBase("10.0.2.0", "255.255.255.0");
+    Ipv4InterfaceContainer serverInterfaces = address.Assign(m_serverDevices);
+    m_server = serverNodes.Get(1);
+    m_serverAddress = serverInterfaces.GetAddress(1);
+
+    // p2p between R1 and R2
+    m_routers.Add(star.GetHub());
+    m_routers.Add(serverNodes.Get(0));
+    pointToPoint.SetDeviceAttribute("DataRate", DataRateValue(m_bottleneckRate));
+    pointToPoint.SetChannelAttribute("Delay", TimeValue(m_bottleneckDelay));
+    bool marking = m_queueDisc == "Red" || m_queueDisc == "CoDel";
+    if (marking)
+    {
+        pointToPoint.SetQueue("ns3::DropTailQueue", "MaxSize", QueueSizeValue(QueueSize("1p")));
+    }
+    m_routerDevices = pointToPoint.Install(m_routers);
+    if (marking)
+    {
+        // before the addresses, which would install the default queue disc
+        TrafficControlHelper tch;
+        if (m_queueDisc == "Red")
+        {
+            tch.SetRootQueueDisc("ns3::RedQueueDisc",
+                                 "UseEcn",
+                                 BooleanValue(true),
+                                 "LinkBandwidth",
+                                 DataRateValue(m_bottleneckRate),
+                                 "LinkDelay",
+                                 TimeValue(m_bottleneckDelay));
+        }
+        else
+        {
+            tch.SetRootQueueDisc("ns3::CoDelQueueDisc", "UseEcn", BooleanValue(true));
+        }
+        m_bottleneckQueueDisc = tch.Install(m_routerDevices.Get(0)).Get(0);
+    }
+    address.SetBase("10.0.0.0", "255.255.255.252");
+    address.Assign(m_routerDevices);
+    if (m_queueDisc == "DropTail")
+    {
+        // Assign gave R1 the default FqCoDel, as with None; without it the
+        // bottleneck queues in its DropTail device queue
+        TrafficControlHelper().Uninstall(m_routerDevices.Get(0));
+    }
+
+    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+}
+
+uint32_t
+MasticcTopologyHelper::GetNClients() const
+{
+    return m_nClients;
+}
+
+Ptr<Node>
+MasticcTopologyHelper::GetClient(uint32_t i) const
+{
+    return m_clients.Get(i);
+}
+
+Ptr<NetDevice>
+MasticcTopologyHelper::GetClientDevice(uint32_t i) const
+{
+    return m_clientDevices.Get(i);
+}
+
+Ipv4Address
+MasticcTopologyHelper::GetClientAddress(uint32_t i) const
+{
+    return m_clientAddresses.at(i);
+}
+
+Ptr<Node>
+MasticcTopologyHelper::GetRouter1() const
+{
+    return m_routers.Get(0);
+}
+
+Ptr<Node>
+MasticcTopologyHelper::GetRouter2() const
+{
+    return m_routers.Get(1);
+}
+
+Ptr<Node>
+MasticcTopologyHelper::GetServer() const
+{
+    return m_server;
+}
+
+Ipv4Address
+MasticcTopologyHelper::GetServerAddress() const
+{
+    return m_serverAddress;
+}
+
+Ptr<NetDevice>
+MasticcTopologyHelper::GetBottleneckDevice() const
+{
+    return m_routerDevices.Get(0);
+}
+
+Ptr<QueueDisc>
+MasticcTopologyHelper::GetBottleneckQueueDisc() const
+{
+    return m_bottleneckQueueDisc;
+}
+
+Ptr<NetDevice>
+MasticcTopologyHelper::GetServerLinkDevice() const
+{
+    return m_serverDevices.Get(0);
+}
+
+} // namespace ns3
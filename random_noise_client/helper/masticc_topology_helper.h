@@ -0,0 +1,178 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MASTICC_TOPOLOGY_HELPER_H
+#define MASTICC_TOPOLOGY_HELPER_H
+
+#include "ns3/data-rate.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/net-device-container.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/queue-disc.h"
+#include "ns3/queue-size.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup randomnoise
+ * \brief Builds the masticc client-server topology.
+ *
+ * \verbatim
+ *        C0
+ *          \ 192.168.0.0
+ *      .1.0 \
+ * C1 ------- R1 ------------ R2 ------------ Server
+ *           / 10.0.0.0 10.0.2.0
+ *          / .2.0
+ *        C2
+ * \endverbatim
+ *
+ * The clients are the spokes of a star around R1. R1-R2 is the bottleneck,
+ * every other link is an access link. Install() also installs the internet
+ * stack, assigns the addresses and populates the global routing tables.
+ */
+class MasticcTopologyHelper
+{
+  public:
+    MasticcTopologyHelper();
+
+    /**
+     * \param nClients number of clients connected to R1, at least 2
+     */
+    void SetNClients(uint32_t nClients);
+
+    /**
+     * \brief Set the client and server links.
+     * \param rate link rate
+     * \param delay propagation delay
+     */
+    void SetAccessLink(DataRate rate, Time delay);
+
+    /**
+     * \brief Set the R1-R2 link.
+     * \param rate link rate
+     * \param delay propagation delay
+     */
+    void SetBottleneckLink(DataRate rate, Time delay);
+
+    /**
+     * \param size size of the transmit queue of every device
+     */
+    void SetQueueSize(QueueSize size);
+
+    /**
+     * \brief Set the queue disc of R1 towards R2.
+     *
+     * Red and CoDel mark ECN capable packets instead of dropping them; the
+     * device queue of R1 is then cut to one packet so that the backlog
+     * builds up in the queue disc.
+     *
+     * \param type None (the default FqCoDel of the traffic control layer),
+     *        DropTail (the device queue only, without the FqCoDel), Red or CoDel
+     */
+    void SetBottleneckQueueDisc(const std::string& type);
+
+    /**
+     * \brief Create the nodes and links.
+     */
+    void Install();
+
+    /**
+     * \return the number of clients
+     */
+    uint32_t GetNClients() const;
+
+    /**
+     * \param i client index
+     * \return the client node
+     */
+    Ptr<Node> GetClient(uint32_t i) const;
+
+    /**
+     * \param i client index
+     * \return the device of the client towards R1
+     */
+    Ptr<NetDevice> GetClientDevice(uint32_t i) const;
+
+    /**
+     * \param i client index
+     * \return the address of the client
+     */
+    Ipv4Address GetClientAddress(uint32_t i) const;
+
+    /**
+     * \return R1, the hub of the clients
+     */
+    Ptr<Node> GetRouter1() const;
+
+    /**
+     * \return R2
+     */
+    Ptr<Node> GetRouter2() const;
+
+    /**
+     * \return the server node
+     */
+    Ptr<Node> GetServer() const;
+
+    /**
+     * \return the address of the server
+     */
+    Ipv4Address GetServerAddress() const;
+
+    /**
+     * \return the device of R1 towards R2, whose queue is the bottleneck
+     */
+    Ptr<NetDevice> GetBottleneckDevice() const;
+
+    /**
+     * \return the queue disc of the bottleneck, null with None and DropTail
+     */
+    Ptr<QueueDisc> GetBottleneckQueueDisc() const;
+
+    /**
+     * \return the device of R2 towards the server
+     */
+    Ptr<NetDevice> GetServerLinkDevice() const;
+
+  private:
+    uint32_t m_nClients;       //!< Number of clients
+    DataRate m_accessRate;     //!< Rate of the access links
+    Time m_accessDelay;        //!< Delay of the access links
+    DataRate m_bottleneckRate; //!< Rate of R1-R2
+    Time m_bottleneckDelay;    //!< Delay of R1-R2
+    QueueSize m_queueSize;     //!< Transmit queue of every device
+    std::string m_queueDisc;   //!< Queue disc of the bottleneck: None, DropTail, Red or CoDel
+
+    NodeContainer m_clients;                    //!< Client nodes
+    NetDeviceContainer m_clientDevices;         //!< Client devices towards R1
+    std::vector<Ipv4Address> m_clientAddresses; //!< Client addresses
+    NodeContainer m_routers;                    //!< R1 and R2
+    NetDeviceContainer m_routerDevices;         //!< R1-R2 devices
+    Ptr<Node> m_server;                         //!< Server node
+    NetDeviceContainer m_serverDevices;         //!< R2-server devices
+    Ipv4Address m_serverAddress;                //!< Address of the server
+    Ptr<QueueDisc> m_bottleneckQueueDisc;       //!< Queue disc of R1 towards R2
+};
+
+} // namespace ns3
+
+#endif /* MASTICC_TOPOLOGY_HELPER_H */
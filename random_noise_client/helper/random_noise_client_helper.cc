@@ -22,6 +22,8 @@
 #include "ns3/random_noise_client.h"
 #include "ns3/uinteger.h"
 
+#include <algorithm>
+
 namespace ns3
 {
 
@@ -90,6 +92,59 @@ RandomNoiseClientHelper::Install(NodeContainer c) const
     return apps;
 }
 
+int64_t
+RandomNoiseClientHelper::AssignStreams(NodeContainer c, int64_t stream)
+{
+    int64_t currentStream = stream;
+    for (auto node = c.Begin(); node != c.End(); ++node)
+    {
+        for (uint32_t i = 0; i < (*node)->GetNApplications(); i++)
+        {
+            Ptr<RandomNoiseClient> client = DynamicCast<RandomNoiseClient>((*node)->GetApplication(i));
+            if (client)
+            {
+                currentStream += client->AssignStreams(currentStream);
+            }
+        }
+    }
+    return currentStream - stream;
+}
+
+void
+RandomNoiseClientHelper::PrintMemoryUsage(const ApplicationContainer& apps, std::ostream& os)
+{
+    uint32_t n = 0;
+    RandomNoiseClient::MemoryUsage sum;
+    uint64_t total = 0;
+    uint32_t largest = 0;
+    for (auto app = apps.Begin(); app != apps.End(); ++app)
+    {
+        Ptr<RandomNoiseClient> client = DynamicCast<RandomNoiseClient>(*app);
+        if (!client)
+        {
+            continue;
+        }
+        RandomNoiseClient::MemoryUsage usage = client->GetMemoryUsage();
+        sum.object += usage.object;
+        sum.config += usage.config;
+        sum.randomVariables += usage.randomVariables;
+        sum.sendTimes += usage.sendTimes;
+        sum.predictor += usage.predictor;
+        total += usage.GetTotal();
+        largest = std::max(largest, usage.GetTotal());
+        n++;
+    }
+    os << "memory of " << n << " RandomNoiseClients";
+    if (n > 0)
+    {
+        os << ", bytes per client: object " << sum.object / n << ", config " << sum.config / n
+           << ", random variables " << sum.randomVariables / n << ", send times "
+           << sum.sendTimes / n << ", predictor " << sum.predictor / n << ", total "
+           << total / n << " (largest " << largest << "); " << total / 1e6 << " MB in all";
+    }
+    os << '\n';
+}
+
 Ptr<Application>
 RandomNoiseClientHelper::InstallPriv(Ptr<Node> node) const
 {
@@ -25,6 +25,7 @@
 #include "ns3/node-container.h"
 #include "ns3/object-factory.h"
 
+#include <ostream>
 #include <stdint.h>
 
 namespace ns3
@@ -146,6 +147,26 @@ class RandomNoiseClientHelper
      */
     ApplicationContainer Install(NodeContainer c) const;
 
+    /**
+     * Assign a fixed random variable stream number to the random variables
+     * used by the RandomNoiseClients on the given nodes. Call it again after
+     * RngSeedManager::SetRun() to draw the run's substream.
+     *
+     * \param c the nodes whose applications use the streams
+     * \param stream first stream index to use
+     * \return the number of stream indices assigned
+     */
+    int64_t AssignStreams(NodeContainer c, int64_t stream);
+
+    /**
+     * Print the memory held by RandomNoiseClients: the mean of every part
+     * of RandomNoiseClient::GetMemoryUsage, the largest client and the total.
+     *
+     * \param apps the applications, other than RandomNoiseClients are skipped
+     * \param os the output stream
+     */
+    static void PrintMemoryUsage(const ApplicationContainer& apps, std::ostream& os);
+
   private:
     /**
      * Install an ns3::RandomNoiseClient on the node configured with all the
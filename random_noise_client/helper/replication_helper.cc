@@ -0,0 +1,224 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "replication_helper.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/rng-seed-manager.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("ReplicationHelper");
+
+namespace
+{
+
+/// Two-sided 95% quantiles of Student's t for 1 to 30 degrees of freedom
+const double T_QUANTILE_95[30] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306,
+                                  2.262,  2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120,
+                                  2.110,  2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064,
+                                  2.060,  2.056, 2.052, 2.048, 2.045, 2.042};
+
+} // namespace
+
+ReplicationHelper::ReplicationHelper()
+    : m_replications(1),
+      m_jobs(0),
+      m_firstRun(RngSeedManager::GetRun()),
+      m_independentRuns(true)
+{
+}
+
+void
+ReplicationHelper::SetReplications(uint32_t replications)
+{
+    m_replications = replications;
+}
+
+void
+ReplicationHelper::SetJobs(uint32_t jobs)
+{
+    m_jobs = jobs;
+}
+
+void
+ReplicationHelper::SetFirstRun(uint32_t run)
+{
+    m_firstRun = run;
+}
+
+void
+ReplicationHelper::SetIndependentRuns(bool independent)
+{
+    m_independentRuns = independent;
+}
+
+uint32_t
+ReplicationHelper::AddMetric(std::string name)
+{
+    m_names.push_back(std::move(name));
+    return m_names.size() - 1;
+}
+
+void
+ReplicationHelper::Run(Replication replication)
+{
+    NS_LOG_FUNCTION(this << m_replications);
+    uint32_t nMetrics = m_names.size();
+    // per replication: a completion flag, then the metrics
+    size_t slotSize = (nMetrics + 1) * sizeof(double);
+    size_t size = slotSize * m_replications;
+    void* shared = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    NS_ABORT_MSG_IF(shared == MAP_FAILED, "Could not map " << size << " bytes: " << strerror(errno));
+    memset(shared, 0, size);
+    auto slot = [shared, slotSize](uint32_t i) {
+        return reinterpret_cast<double*>(static_cast<char*>(shared) + i * slotSize);
+    };
+
+    uint32_t jobs = m_jobs > 0 ? m_jobs : std::max<long>(sysconf(_SC_NPROCESSORS_ONLN), 1);
+    uint32_t running = 0;
+    std::cout.flush();
+    std::clog.flush();
+    fflush(nullptr);
+    for (uint32_t i = 0; i < m_replications; i++)
+    {
+        if (running == jobs)
+        {
+            wait(nullptr);
+            running--;
+        }
+        pid_t pid = fork();
+        NS_ABORT_MSG_IF(pid < 0, "fork failed: " << strerror(errno));
+        if (pid == 0)
+        {
+            if (m_independentRuns)
+            {
+                RngSeedManager::SetRun(m_firstRun + i);
+            }
+            double* metrics = slot(i);
+            replication(i, metrics + 1);
+            metrics[0] = 1;
+            std::cout.flush();
+            std::clog.flush();
+            fflush(nullptr);
+            // skip the destructors of the parent's objects
+            _exit(0);
+        }
+        running++;
+    }
+    while (running > 0)
+    {
+        wait(nullptr);
+        running--;
+    }
+
+    m_completed.assign(m_replications, false);
+    m_values.assign(m_replications, std::vector<double>(nMetrics, 0));
+    for (uint32_t i = 0; i < m_replications; i++)
+    {
+        const double* metrics = slot(i);
+        if (metrics[0] == 0)
+        {
+            NS_LOG_WARN("Replication " << i << " did not complete");
+            continue;
+        }
+        m_completed[i] = true;
+        std::copy(metrics + 1, metrics + 1 + nMetrics, m_values[i].begin());
+    }
+    munmap(shared, size);
+}
+
+uint32_t
+ReplicationHelper::GetNCompleted() const
+{
+    return std::count(m_completed.begin(), m_completed.end(), true);
+}
+
+bool
+ReplicationHelper::IsCompleted(uint32_t replication) const
+{
+    return m_completed.at(replication);
+}
+
+double
+ReplicationHelper::GetValue(uint32_t replication, uint32_t metric) const
+{
+    return m_values.at(replication).at(metric);
+}
+
+double
+ReplicationHelper::GetMean(uint32_t metric) const
+{
+    uint32_t n = GetNCompleted();
+    if (n == 0)
+    {
+        return 0;
+    }
+    double sum = 0;
+    for (uint32_t i = 0; i < m_values.size(); i++)
+    {
+        sum += m_completed[i] ? m_values[i][metric] : 0;
+    }
+    return sum / n;
+}
+
+double
+ReplicationHelper::GetConfidence95(uint32_t metric) const
+{
+    uint32_t n = GetNCompleted();
+    if (n < 2)
+    {
+        return 0;
+    }
+    double mean = GetMean(metric);
+    double sum = 0;
+    for (uint32_t i = 0; i < m_values.size(); i++)
+    {
+        double value = m_completed[i] ? m_values[i][metric] : mean;
+        sum += (value - mean) * (value - mean);
+    }
+    double stdev = std::sqrt(sum / (n - 1));
+    double t = n - 1 <= 30 ? T_QUANTILE_95[n - 2] : 1.960;
+    return t * stdev / std::sqrt(n);
+}
+
+void
+ReplicationHelper::Print(std::ostream& os) const
+{
+    os << GetNCompleted() << " of " << m_replications << " replications completed";
+    if (m_independentRuns)
+    {
+        os << " (runs " << m_firstRun << " to " << m_firstRun + m_replications - 1 << ")";
+    }
+    os << '\n';
+    for (uint32_t m = 0; m < m_names.size(); m++)
+    {
+        os << "  " << m_names[m] << ": " << GetMean(m) << " +- " << GetConfidence95(m)
+           << " (95% CI)\n";
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,141 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef REPLICATION_HELPER_H
+#define REPLICATION_HELPER_H
+
+#include <functional>
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup randomnoise
+ * \brief Runs independent replications of a scenario in forked workers.
+ *
+ * The scenario is built once in the parent. Run() then forks one worker per
+ * replication, at most a given number at a time. Workers share the parent's
+ * topology, routing tables and loaded models copy-on-write; each one sets
+ * its own RngRun, runs the simulation and writes its metrics to a slot in
+ * anonymous shared memory. The parent never runs the simulator.
+ *
+ * Random variables draw their substream when they are created, so the
+ * replication callback must reassign the streams of every random variable of
+ * the scenario (see RandomNoiseClientHelper::AssignStreams) after the run
+ * number is set.
+ *
+ * Without independent runs the workers keep the parent's run and random
+ * stream positions: they are branches of the same simulation, e.g. variants
+ * forked after a warm-up that the parent simulated once.
+ */
+class ReplicationHelper
+{
+  public:
+    /**
+     * \brief A replication: run the simulation and fill in the metrics.
+     *
+     * Called in the worker with the run number already set. The metrics
+     * array has one entry per AddMetric() call and starts zeroed.
+     */
+    typedef std::function<void(uint32_t replication, double* metrics)> Replication;
+
+    ReplicationHelper();
+
+    /**
+     * \param replications number of replications to run
+     */
+    void SetReplications(uint32_t replications);
+
+    /**
+     * \param jobs maximum number of concurrent workers, 0 for the number of cores
+     */
+    void SetJobs(uint32_t jobs);
+
+    /**
+     * \param run RngRun of the first replication, the others follow consecutively
+     */
+    void SetFirstRun(uint32_t run);
+
+    /**
+     * \param independent if false, workers keep the parent's run and stream positions
+     */
+    void SetIndependentRuns(bool independent);
+
+    /**
+     * \brief Declare a metric reported by every replication.
+     * \param name name in the summary
+     * \return the index of the metric in the metrics array
+     */
+    uint32_t AddMetric(std::string name);
+
+    /**
+     * \brief Fork the workers and wait for all of them.
+     * \param replication the work of one replication
+     */
+    void Run(Replication replication);
+
+    /**
+     * \return the number of replications that completed
+     */
+    uint32_t GetNCompleted() const;
+
+    /**
+     * \param replication replication index
+     * \return true if the replication completed
+     */
+    bool IsCompleted(uint32_t replication) const;
+
+    /**
+     * \param replication index of a completed replication
+     * \param metric metric index
+     * \return the value reported by the replication
+     */
+    double GetValue(uint32_t replication, uint32_t metric) const;
+
+    /**
+     * \param metric metric index
+     * \return the mean over the completed replications
+     */
+    double GetMean(uint32_t metric) const;
+
+    /**
+     * \param metric metric index
+     * \return half width of the 95% confidence interval of the mean
+     */
+    double GetConfidence95(uint32_t metric) const;
+
+    /**
+     * \brief Print mean and 95% confidence interval of every metric.
+     * \param os the output stream
+     */
+    void Print(std::ostream& os) const;
+
+  private:
+    uint32_t m_replications;                   //!< Replications to run
+    uint32_t m_jobs;                           //!< Concurrent workers, 0 for the number of cores
+    uint32_t m_firstRun;                       //!< RngRun of the first replication
+    bool m_independentRuns;                    //!< Each worker sets its own RngRun
+    std::vector<std::string> m_names;          //!< Metric names
+    std::vector<bool> m_completed;             //!< Per replication, true if it completed
+    std::vector<std::vector<double>> m_values; //!< Metrics per replication
+};
+
+} // namespace ns3
+
+#endif /* REPLICATION_HELPER_H */
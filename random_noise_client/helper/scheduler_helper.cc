@@ -0,0 +1,53 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/scheduler_helper.h"
+
+#include "ns3/abort.h"
+#include "ns3/config.h"
+#include "ns3/log.h"
+#include "ns3/scheduler.h"
+#include "ns3/string.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("SchedulerHelper");
+
+std::vector<std::string>
+SchedulerHelper::GetNames()
+{
+    return {"Map", "Heap", "Calendar", "PriorityQueue", "TimingWheel"};
+}
+
+TypeId
+SchedulerHelper::Lookup(const std::string& name)
+{
+    std::string fullName =
+        name.find("::") == std::string::npos ? "ns3::" + name + "Scheduler" : name;
+    TypeId tid;
+    NS_ABORT_MSG_UNLESS(TypeId::LookupByNameFailSafe(fullName, &tid) &&
+                            tid.IsChildOf(Scheduler::GetTypeId()),
+                        "Unknown scheduler " << name);
+    return tid;
+}
+
+void
+SchedulerHelper::Set(const std::string& name)
+{
+    NS_LOG_FUNCTION(name);
+    Config::SetGlobal("SchedulerType", StringValue(Lookup(name).GetName()));
+}
+
+} // namespace ns3
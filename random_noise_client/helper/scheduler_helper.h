@@ -0,0 +1,63 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SCHEDULER_HELPER_H
+#define SCHEDULER_HELPER_H
+
+#include "ns3/type-id.h"
+
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup randomnoise
+ * \brief Selects the event scheduler of the masticc tools by short name.
+ *
+ * Short names are Map, Heap, Calendar, PriorityQueue and TimingWheel; a
+ * full TypeId name such as ns3::ListScheduler is accepted as well.
+ */
+class SchedulerHelper
+{
+  public:
+    /**
+     * \return the short names of the schedulers worth comparing
+     */
+    static std::vector<std::string> GetNames();
+
+    /**
+     * \brief Resolve a scheduler name, aborting if it is not a Scheduler.
+     * \param name short or full TypeId name
+     * \return the scheduler's TypeId
+     */
+    static TypeId Lookup(const std::string& name);
+
+    /**
+     * \brief Use a scheduler for the next simulations.
+     *
+     * Sets the SchedulerType global value, which takes effect when the
+     * simulator is created: before the first event is scheduled, or after
+     * Simulator::Destroy().
+     *
+     * \param name short or full TypeId name
+     */
+    static void Set(const std::string& name);
+};
+
+} // namespace ns3
+
+#endif /* SCHEDULER_HELPER_H */
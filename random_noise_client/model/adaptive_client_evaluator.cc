@@ -0,0 +1,346 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/adaptive_client_evaluator.h"
+
+#include "ns3/abort.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/point-to-point-net-device.h"
+#include "ns3/ppp-header.h"
+#include "ns3/queue-disc.h"
+#include "ns3/queue.h"
+#include "ns3/random_noise_client.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/traffic-control-layer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("AdaptiveClientEvaluator");
+
+NS_OBJECT_ENSURE_REGISTERED(AdaptiveClientEvaluator);
+
+TypeId
+AdaptiveClientEvaluator::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::AdaptiveClientEvaluator")
+            .SetParent<Object>()
+            .SetGroupName("Applications")
+            .AddConstructor<AdaptiveClientEvaluator>()
+            .AddAttribute("OutputFile",
+                          "CSV file with the predicted and the true ratio of every prediction, "
+                          "empty for none",
+                          StringValue(""),
+                          MakeStringAccessor(&AdaptiveClientEvaluator::m_outputFile),
+                          MakeStringChecker());
+    return tid;
+}
+
+AdaptiveClientEvaluator::AdaptiveClientEvaluator()
+    : m_running(false),
+      m_intervalBits(0),
+      m_bottleneckBits(0),
+      m_predictions(0),
+      m_absoluteErrorSum(0),
+      m_goodputBits(0),
+      m_noiseBits(0),
+      m_adaptiveDrops(0),
+      m_noiseDrops(0),
+      m_adaptiveMarks(0),
+      m_noiseMarks(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+AdaptiveClientEvaluator::~AdaptiveClientEvaluator()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+AdaptiveClientEvaluator::SetClient(Ptr<RandomNoiseClient> client, Ipv4Address address)
+{
+    NS_LOG_FUNCTION(this << client << address);
+    m_client = client;
+    m_clientAddress = address;
+    client->TraceConnectWithoutContext("Prediction",
+                                       MakeCallback(&AdaptiveClientEvaluator::Prediction, this));
+    client->TraceConnectWithoutContext("Rx", MakeCallback(&AdaptiveClientEvaluator::ClientRx, this));
+}
+
+void
+AdaptiveClientEvaluator::SetBottleneck(Ptr<NetDevice> device)
+{
+    NS_LOG_FUNCTION(this << device);
+    Ptr<PointToPointNetDevice> p2p = DynamicCast<PointToPointNetDevice>(device);
+    NS_ABORT_MSG_UNLESS(p2p, "The bottleneck must be a point-to-point device");
+    m_bottleneck = device;
+    DataRateValue rate;
+    p2p->GetAttribute("DataRate", rate);
+    m_capacity = rate.Get();
+    p2p->TraceConnectWithoutContext("PhyTxBegin",
+                                    MakeCallback(&AdaptiveClientEvaluator::BottleneckTx, this));
+    // with a root queue disc (e.g. the FqCoDel Ipv4AddressHelper installs by
+    // default) the backlog and the drops are in the queue disc, which stops
+    // the device queue before it overflows
+    Ptr<TrafficControlLayer> tc = device->GetNode()->GetObject<TrafficControlLayer>();
+    Ptr<QueueDisc> queueDisc = tc ? tc->GetRootQueueDiscOnDevice(device) : nullptr;
+    if (queueDisc)
+    {
+        queueDisc->TraceConnectWithoutContext(
+            "Drop",
+            MakeCallback(&AdaptiveClientEvaluator::QueueDiscDrop, this));
+        queueDisc->TraceConnectWithoutContext(
+            "Mark",
+            MakeCallback(&AdaptiveClientEvaluator::QueueDiscMark, this));
+    }
+    else
+    {
+        p2p->GetQueue()->TraceConnectWithoutContext(
+            "Drop",
+            MakeCallback(&AdaptiveClientEvaluator::BottleneckDrop, this));
+    }
+}
+
+void
+AdaptiveClientEvaluator::AddNoiseSource(Ptr<Application> app)
+{
+    NS_LOG_FUNCTION(this << app);
+    app->TraceConnectWithoutContext("Tx", MakeCallback(&AdaptiveClientEvaluator::NoiseTx, this));
+}
+
+void
+AdaptiveClientEvaluator::Start()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ABORT_MSG_UNLESS(m_client && m_bottleneck, "AdaptiveClientEvaluator is not configured");
+    m_running = true;
+    m_start = Simulator::Now();
+    m_lastPrediction = m_start;
+    if (!m_outputFile.empty())
+    {
+        m_output.open(m_outputFile);
+        if (!m_output.is_open())
+        {
+            NS_FATAL_ERROR("Could not create " << m_outputFile);
+        }
+        m_output << "time,predicted_ratio,true_ratio\n";
+    }
+}
+
+void
+AdaptiveClientEvaluator::Stop()
+{
+    NS_LOG_FUNCTION(this);
+    if (m_running)
+    {
+        m_running = false;
+        m_stop = Simulator::Now();
+    }
+    if (m_output.is_open())
+    {
+        m_output.close();
+    }
+}
+
+void
+AdaptiveClientEvaluator::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    Stop();
+    m_client = nullptr;
+    m_bottleneck = nullptr;
+    Object::DoDispose();
+}
+
+void
+AdaptiveClientEvaluator::Prediction(double ratio)
+{
+    if (!m_running)
+    {
+        return;
+    }
+    // same definition as bw_ratio in the training data
+    Time now = Simulator::Now();
+    double dt = (now - m_lastPrediction).GetSeconds();
+    double occupied =
+        dt > 0 ? m_intervalBits / dt / m_capacity.GetBitRate() : (m_intervalBits > 0 ? 1 : 0);
+    double trueRatio = 1 - std::min(occupied, 1.0);
+    // Send() paces with the clamped prediction
+    double predicted = std::clamp(ratio, 0.0, 1.0);
+
+    m_absoluteErrorSum += std::abs(predicted - trueRatio);
+    m_predictions++;
+    m_intervalBits = 0;
+    m_lastPrediction = now;
+    if (m_output.is_open())
+    {
+        m_output << now.GetSeconds() << ',' << predicted << ',' << trueRatio << '\n';
+    }
+}
+
+void
+AdaptiveClientEvaluator::ClientRx(Ptr<const Packet> packet)
+{
+    if (m_running)
+    {
+        m_goodputBits += packet->GetSize() * 8;
+    }
+}
+
+void
+AdaptiveClientEvaluator::NoiseTx(Ptr<const Packet> packet)
+{
+    if (m_running)
+    {
+        m_noiseBits += packet->GetSize() * 8;
+    }
+}
+
+void
+AdaptiveClientEvaluator::BottleneckTx(Ptr<const Packet> packet)
+{
+    if (m_running)
+    {
+        m_intervalBits += packet->GetSize() * 8;
+        m_bottleneckBits += packet->GetSize() * 8;
+    }
+}
+
+void
+AdaptiveClientEvaluator::BottleneckDrop(Ptr<const Packet> packet)
+{
+    if (!m_running)
+    {
+        return;
+    }
+    Ptr<Packet> copy = packet->Copy();
+    PppHeader ppp;
+    Ipv4Header ip;
+    if (copy->RemoveHeader(ppp) && copy->PeekHeader(ip) && ip.GetSource() == m_clientAddress)
+    {
+        m_adaptiveDrops++;
+    }
+    else
+    {
+        m_noiseDrops++;
+    }
+}
+
+bool
+AdaptiveClientEvaluator::IsClientItem(Ptr<const QueueDiscItem> item) const
+{
+    Ptr<const Ipv4QueueDiscItem> ipItem = DynamicCast<const Ipv4QueueDiscItem>(item);
+    return ipItem && ipItem->GetHeader().GetSource() == m_clientAddress;
+}
+
+void
+AdaptiveClientEvaluator::QueueDiscDrop(Ptr<const QueueDiscItem> item)
+{
+    if (!m_running)
+    {
+        return;
+    }
+    if (IsClientItem(item))
+    {
+        m_adaptiveDrops++;
+    }
+    else
+    {
+        m_noiseDrops++;
+    }
+}
+
+void
+AdaptiveClientEvaluator::QueueDiscMark(Ptr<const QueueDiscItem> item, const char* reason)
+{
+    if (!m_running)
+    {
+        return;
+    }
+    if (IsClientItem(item))
+    {
+        m_adaptiveMarks++;
+    }
+    else
+    {
+        m_noiseMarks++;
+    }
+}
+
+double
+AdaptiveClientEvaluator::GetDuration() const
+{
+    return ((m_running ? Simulator::Now() : m_stop) - m_start).GetSeconds();
+}
+
+double
+AdaptiveClientEvaluator::GetMeanAbsoluteError() const
+{
+    return m_predictions > 0 ? m_absoluteErrorSum / m_predictions : 0;
+}
+
+double
+AdaptiveClientEvaluator::GetUtilization() const
+{
+    double duration = GetDuration();
+    return duration > 0 ? m_bottleneckBits / duration / m_capacity.GetBitRate() : 0;
+}
+
+double
+AdaptiveClientEvaluator::GetGoodput() const
+{
+    double duration = GetDuration();
+    return duration > 0 ? m_goodputBits / duration : 0;
+}
+
+double
+AdaptiveClientEvaluator::GetNoiseLoad() const
+{
+    double duration = GetDuration();
+    return duration > 0 ? m_noiseBits / duration : 0;
+}
+
+void
+AdaptiveClientEvaluator::Print(std::ostream& os) const
+{
+    double capacity = m_capacity.GetBitRate();
+    double leftover = std::max(capacity - GetNoiseLoad(), 0.0);
+    os << "adaptive client evaluation over " << GetDuration() << " s\n"
+       << "  predictions: " << m_predictions << ", mean absolute error "
+       << GetMeanAbsoluteError() << '\n'
+       << "  bottleneck utilization: " << GetUtilization() << '\n'
+       << "  bottleneck drops: " << m_adaptiveDrops << " adaptive, " << m_noiseDrops
+       << " other\n"
+       << "  bottleneck ECN marks: " << m_adaptiveMarks << " adaptive, " << m_noiseMarks
+       << " other\n"
+       << "  goodput: " << GetGoodput() / 1e6 << " Mbps with a noise load of "
+       << GetNoiseLoad() / 1e6 << " Mbps on " << capacity / 1e6 << " Mbps";
+    if (leftover > 0)
+    {
+        os << " (" << GetGoodput() / leftover << " of the capacity left by the noise)";
+    }
+    os << '\n';
+}
+
+} // namespace ns3
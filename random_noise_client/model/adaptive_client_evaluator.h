@@ -0,0 +1,195 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ADAPTIVE_CLIENT_EVALUATOR_H
+#define ADAPTIVE_CLIENT_EVALUATOR_H
+
+#include "ns3/data-rate.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+
+#include <fstream>
+#include <ostream>
+#include <stdint.h>
+
+namespace ns3
+{
+
+class Application;
+class NetDevice;
+class Packet;
+class QueueDiscItem;
+class RandomNoiseClient;
+
+/**
+ * \ingroup randomnoise
+ * \brief Scores the adaptive client against the true state of the bottleneck.
+ *
+ * At every prediction of the client the true available ratio of the R1->R2
+ * link is computed over the same interval the training labels use (since
+ * the previous prediction): one minus the bits that started transmission on
+ * the link divided by its capacity. Over the evaluation period it reports
+ * the mean absolute error of the predictions, the utilization of the link,
+ * the drops of adaptive and noise packets at the bottleneck queue, and the
+ * goodput of the adaptive client next to the offered noise load.
+ */
+class AdaptiveClientEvaluator : public Object
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    AdaptiveClientEvaluator();
+    ~AdaptiveClientEvaluator() override;
+
+    /**
+     * \param client the adaptive client
+     * \param address the address the client sends from
+     */
+    void SetClient(Ptr<RandomNoiseClient> client, Ipv4Address address);
+
+    /**
+     * \brief Set the bottleneck, after its queue disc is installed.
+     *
+     * Drops and ECN marks are counted in the root queue disc of the device
+     * when it has one, else in the device queue.
+     *
+     * \param device point-to-point device of R1 towards R2
+     */
+    void SetBottleneck(Ptr<NetDevice> device);
+
+    /**
+     * \param app an application whose Tx trace is the noise load
+     */
+    void AddNoiseSource(Ptr<Application> app);
+
+    /**
+     * \brief Start the evaluation period.
+     */
+    void Start();
+
+    /**
+     * \brief End the evaluation period, e.g. when the applications stop.
+     */
+    void Stop();
+
+    /**
+     * \return the mean absolute error of the clamped predictions
+     */
+    double GetMeanAbsoluteError() const;
+
+    /**
+     * \return the fraction of the bottleneck capacity that was used
+     */
+    double GetUtilization() const;
+
+    /**
+     * \return the goodput of the adaptive client (bit/s)
+     */
+    double GetGoodput() const;
+
+    /**
+     * \return the load offered by the noise sources (bit/s)
+     */
+    double GetNoiseLoad() const;
+
+    /**
+     * \brief Print the summary of the evaluation period.
+     * \param os the output stream
+     */
+    void Print(std::ostream& os) const;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    /**
+     * \param ratio the prediction of the client
+     */
+    void Prediction(double ratio);
+
+    /**
+     * \param packet echo received by the client
+     */
+    void ClientRx(Ptr<const Packet> packet);
+
+    /**
+     * \param packet packet sent by a noise source
+     */
+    void NoiseTx(Ptr<const Packet> packet);
+
+    /**
+     * \param packet packet starting transmission on the bottleneck
+     */
+    void BottleneckTx(Ptr<const Packet> packet);
+
+    /**
+     * \param packet packet dropped by the bottleneck device queue
+     */
+    void BottleneckDrop(Ptr<const Packet> packet);
+
+    /**
+     * \param item packet dropped by the bottleneck queue disc
+     */
+    void QueueDiscDrop(Ptr<const QueueDiscItem> item);
+
+    /**
+     * \param item packet marked Congestion Experienced by the bottleneck queue disc
+     * \param reason reason of the mark
+     */
+    void QueueDiscMark(Ptr<const QueueDiscItem> item, const char* reason);
+
+    /**
+     * \param item packet seen by the bottleneck queue disc
+     * \return whether it was sent by the adaptive client
+     */
+    bool IsClientItem(Ptr<const QueueDiscItem> item) const;
+
+    /**
+     * \return the evaluated time (s)
+     */
+    double GetDuration() const;
+
+    std::string m_outputFile;        //!< Per-prediction CSV, empty for none
+    std::ofstream m_output;          //!< Per-prediction output
+    Ptr<RandomNoiseClient> m_client; //!< Evaluated client
+    Ipv4Address m_clientAddress;     //!< Source address of the client
+    Ptr<NetDevice> m_bottleneck;     //!< R1->R2 device
+    DataRate m_capacity;             //!< Rate of the bottleneck
+
+    bool m_running;            //!< Inside the evaluation period
+    Time m_start;              //!< Start of the evaluation period
+    Time m_stop;               //!< End of the evaluation period
+    Time m_lastPrediction;     //!< Time of the previous prediction
+    uint64_t m_intervalBits;   //!< Bottleneck bits since the previous prediction
+    uint64_t m_bottleneckBits; //!< Bottleneck bits in the evaluation period
+    uint64_t m_predictions;    //!< Predictions made
+    double m_absoluteErrorSum; //!< Sum of |prediction - true ratio|
+    uint64_t m_goodputBits;    //!< Bits echoed back to the client
+    uint64_t m_noiseBits;      //!< Bits sent by the noise sources
+    uint64_t m_adaptiveDrops;  //!< Client packets dropped at the bottleneck
+    uint64_t m_noiseDrops;     //!< Other packets dropped at the bottleneck
+    uint64_t m_adaptiveMarks;  //!< Client packets marked CE at the bottleneck
+    uint64_t m_noiseMarks;     //!< Other packets marked CE at the bottleneck
+};
+
+} // namespace ns3
+
+#endif /* ADAPTIVE_CLIENT_EVALUATOR_H */
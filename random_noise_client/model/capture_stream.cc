@@ -0,0 +1,170 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/capture_stream.h"
+
+#include "ns3/log.h"
+
+#include <string.h>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("CaptureStream");
+
+bool
+PcapStream::Open(const std::string& path)
+{
+    if (!m_file.Open(path) || m_file.GetSize() < 24)
+    {
+        return false;
+    }
+    m_file.AdviseSequential();
+    uint32_t magic;
+    memcpy(&magic, m_file.GetData(), 4);
+    switch (magic)
+    {
+    case 0xa1b2c3d4:
+        m_swap = false;
+        m_tsScale = 1e-6;
+        break;
+    case 0xd4c3b2a1:
+        m_swap = true;
+        m_tsScale = 1e-6;
+        break;
+    case 0xa1b23c4d:
+        m_swap = false;
+        m_tsScale = 1e-9;
+        break;
+    case 0x4d3cb2a1:
+        m_swap = true;
+        m_tsScale = 1e-9;
+        break;
+    default:
+        return false;
+    }
+    m_linkType = Read32(20);
+    m_offset = 24;
+    return true;
+}
+
+bool
+PcapStream::Next(CapturedPacket& packet)
+{
+    const uint8_t* data = m_file.GetData();
+    while (m_offset + 16 <= m_file.GetSize())
+    {
+        uint32_t sec = Read32(m_offset);
+        uint32_t frac = Read32(m_offset + 4);
+        uint32_t caplen = Read32(m_offset + 8);
+        uint64_t start = m_offset + 16;
+        m_offset = start + caplen;
+        if (m_offset > m_file.GetSize())
+        {
+            NS_LOG_WARN("Truncated pcap record");
+            return false;
+        }
+        if (m_offset - m_released > RELEASE_CHUNK)
+        {
+            m_file.Release(m_offset);
+            m_released = m_offset;
+        }
+
+        const uint8_t* ip = data + start;
+        uint32_t length = caplen;
+        if (!SkipLinkHeader(ip, length) || length < 20 || (ip[0] >> 4) != 4)
+        {
+            continue;
+        }
+        packet.time = sec + frac * m_tsScale;
+        packet.size = (ip[2] << 8) | ip[3];
+        packet.id = (ip[4] << 8) | ip[5];
+        packet.src = (ip[12] << 24) | (ip[13] << 16) | (ip[14] << 8) | ip[15];
+        bool firstFragment = (((ip[6] << 8) | ip[7]) & 0x1fff) == 0;
+        packet.udp = ip[9] == 17 && firstFragment;
+        return true;
+    }
+    return false;
+}
+
+uint32_t
+PcapStream::Read32(uint64_t offset) const
+{
+    uint32_t value;
+    memcpy(&value, m_file.GetData() + offset, 4);
+    return m_swap ? __builtin_bswap32(value) : value;
+}
+
+bool
+PcapStream::SkipLinkHeader(const uint8_t*& p, uint32_t& length) const
+{
+    uint32_t skip;
+    switch (m_linkType)
+    {
+    case 9: // PPP
+        skip = (length >= 4 && p[0] == 0xff && p[1] == 0x03) ? 2 : 0;
+        if (length < skip + 2 || p[skip] != 0x00 || p[skip + 1] != 0x21)
+        {
+            return false;
+        }
+        skip += 2;
+        break;
+    case 1: // Ethernet
+        if (length < 14 || p[12] != 0x08 || p[13] != 0x00)
+        {
+            return false;
+        }
+        skip = 14;
+        break;
+    case 101: // raw IP
+    case 228: // IPv4
+        skip = 0;
+        break;
+    default:
+        return false;
+    }
+    p += skip;
+    length -= skip;
+    return true;
+}
+
+bool
+CaptureStream::Open(const std::string& path)
+{
+    m_isSummary = m_summary.Open(path);
+    return m_isSummary || m_pcap.Open(path);
+}
+
+bool
+CaptureStream::Next(CapturedPacket& packet)
+{
+    if (!m_isSummary)
+    {
+        return m_pcap.Next(packet);
+    }
+    HeaderSummaryRecord record;
+    if (!m_summary.Next(record))
+    {
+        return false;
+    }
+    packet.time = record.time * 1e-9;
+    packet.id = record.id;
+    packet.src = record.src;
+    packet.size = record.length;
+    // summaries do not keep the protocol; all simulated traffic is UDP
+    packet.udp = true;
+    return true;
+}
+
+} // namespace ns3
@@ -0,0 +1,116 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CAPTURE_STREAM_H
+#define CAPTURE_STREAM_H
+
+#include "ns3/header_summary.h"
+#include "ns3/mapped_file.h"
+
+#include <stdint.h>
+#include <string>
+
+namespace ns3
+{
+
+/**
+ * \ingroup randomnoise
+ * \brief IPv4 fields of a captured packet
+ */
+struct CapturedPacket
+{
+    double time;   //!< Capture time (s)
+    uint16_t id;   //!< IPv4 identification
+    uint32_t src;  //!< IPv4 source, host byte order
+    uint16_t size; //!< IPv4 total length
+    bool udp;      //!< True for the first fragment of a UDP datagram
+};
+
+/**
+ * \ingroup randomnoise
+ * \brief Single pass reader of a pcap file with IPv4 packets.
+ *
+ * Handles both byte orders, microsecond and nanosecond time stamps, and the
+ * PPP (as written by PointToPointNetDevice), raw IP and Ethernet link types.
+ */
+class PcapStream
+{
+  public:
+    /**
+     * \param path the pcap file
+     * \return false if the file is missing or not a pcap file
+     */
+    bool Open(const std::string& path);
+
+    /**
+     * \brief Get the next IPv4 packet, skipping anything else.
+     * \param packet filled in on success
+     * \return false at the end of the file
+     */
+    bool Next(CapturedPacket& packet);
+
+  private:
+    static const uint64_t RELEASE_CHUNK = 64 << 20; //!< Bytes read between page releases
+
+    /**
+     * \param offset file offset
+     * \return the 32 bit field at offset, in host byte order
+     */
+    uint32_t Read32(uint64_t offset) const;
+
+    /**
+     * \brief Advance past the link layer header to the IPv4 header.
+     * \param p start of the packet, moved to the IPv4 header
+     * \param length bytes at p, reduced by the skipped bytes
+     * \return false if the packet does not carry IPv4
+     */
+    bool SkipLinkHeader(const uint8_t*& p, uint32_t& length) const;
+
+    MappedFile m_file;      //!< The capture
+    uint64_t m_offset{0};   //!< Next record
+    uint64_t m_released{0}; //!< Pages before this offset were released
+    bool m_swap{false};     //!< File byte order differs from ours
+    double m_tsScale{1e-6}; //!< Seconds per time stamp fraction unit
+    uint32_t m_linkType{0}; //!< pcap link type
+};
+
+/**
+ * \ingroup randomnoise
+ * \brief Reads either a pcap or a header summary capture.
+ */
+class CaptureStream
+{
+  public:
+    /**
+     * \param path the capture file
+     * \return false if the file is missing or in neither format
+     */
+    bool Open(const std::string& path);
+
+    /**
+     * \param packet filled in on success
+     * \return false at the end of the capture
+     */
+    bool Next(CapturedPacket& packet);
+
+  private:
+    PcapStream m_pcap;             //!< Reader for pcaps
+    HeaderSummaryReader m_summary; //!< Reader for header summaries
+    bool m_isSummary{false};       //!< True if the file is a header summary
+};
+
+} // namespace ns3
+
+#endif /* CAPTURE_STREAM_H */
@@ -0,0 +1,276 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "echo_reflector.h"
+
+#include "ns3/boolean.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/log.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/socket.h"
+#include "ns3/uinteger.h"
+
+#include <vector>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("EchoReflectorApplication");
+
+NS_OBJECT_ENSURE_REGISTERED(EchoReflector);
+
+TypeId
+EchoReflector::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::EchoReflector")
+            .SetParent<Application>()
+            .SetGroupName("Applications")
+            .AddConstructor<EchoReflector>()
+            .AddAttribute("Port",
+                          "Port on which we listen for incoming packets.",
+                          UintegerValue(9),
+                          MakeUintegerAccessor(&EchoReflector::m_port),
+                          MakeUintegerChecker<uint16_t>())
+            .AddAttribute("SampleEvery",
+                          "Reflect one stamped request of every SampleEvery from each sender.",
+                          UintegerValue(1),
+                          MakeUintegerAccessor(&EchoReflector::m_sampleEvery),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("BatchSize",
+                          "Stamps of the same sender sent back in one reply.",
+                          UintegerValue(1),
+                          MakeUintegerAccessor(&EchoReflector::m_batchSize),
+                          MakeUintegerChecker<uint32_t>(1, EchoTimestampHeader::MAX_STAMPS))
+            .AddAttribute("BatchTimeout",
+                          "Longest wait of a partial batch. Zero sends it once the requests "
+                          "queued at the socket are read, so only requests arriving together "
+                          "share a reply.",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&EchoReflector::m_batchTimeout),
+                          MakeTimeChecker(Seconds(0)))
+            .AddAttribute("ReplySize",
+                          "Payload bytes after the timestamps of a stamped reply.",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&EchoReflector::m_replySize),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("EchoUnstamped",
+                          "Echo packets without timestamps back unchanged.",
+                          BooleanValue(true),
+                          MakeBooleanAccessor(&EchoReflector::m_echoUnstamped),
+                          MakeBooleanChecker())
+            .AddTraceSource("Rx",
+                            "A packet has been received",
+                            MakeTraceSourceAccessor(&EchoReflector::m_rxTrace),
+                            "ns3::Packet::TracedCallback")
+            .AddTraceSource("Tx",
+                            "A reply is sent",
+                            MakeTraceSourceAccessor(&EchoReflector::m_txTrace),
+                            "ns3::Packet::TracedCallback");
+    return tid;
+}
+
+EchoReflector::EchoReflector()
+    : m_requests(0),
+      m_reflected(0),
+      m_replies(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+EchoReflector::~EchoReflector()
+{
+    NS_LOG_FUNCTION(this);
+    m_socket = nullptr;
+    m_socket6 = nullptr;
+}
+
+uint64_t
+EchoReflector::GetRequests() const
+{
+    return m_requests;
+}
+
+uint64_t
+EchoReflector::GetReflected() const
+{
+    return m_reflected;
+}
+
+uint64_t
+EchoReflector::GetReplies() const
+{
+    return m_replies;
+}
+
+void
+EchoReflector::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_peers.clear();
+    Application::DoDispose();
+}
+
+void
+EchoReflector::StartApplication()
+{
+    NS_LOG_FUNCTION(this);
+
+    TypeId tid = TypeId::LookupByName("ns3::UdpSocketFactory");
+    if (!m_socket)
+    {
+        m_socket = Socket::CreateSocket(GetNode(), tid);
+        if (m_socket->Bind(InetSocketAddress(Ipv4Address::GetAny(), m_port)) == -1)
+        {
+            NS_FATAL_ERROR("Failed to bind socket");
+        }
+    }
+    if (!m_socket6)
+    {
+        m_socket6 = Socket::CreateSocket(GetNode(), tid);
+        if (m_socket6->Bind(Inet6SocketAddress(Ipv6Address::GetAny(), m_port)) == -1)
+        {
+            NS_FATAL_ERROR("Failed to bind socket");
+        }
+    }
+    // the TOS of every request, for the ECN bits of the stamps
+    m_socket->SetIpRecvTos(true);
+    m_socket->SetRecvCallback(MakeCallback(&EchoReflector::HandleRead, this));
+    m_socket6->SetRecvCallback(MakeCallback(&EchoReflector::HandleRead, this));
+}
+
+void
+EchoReflector::StopApplication()
+{
+    NS_LOG_FUNCTION(this);
+    if (m_socket)
+    {
+        m_socket->Close();
+        m_socket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
+    }
+    if (m_socket6)
+    {
+        m_socket6->Close();
+        m_socket6->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
+    }
+    // stamps still waiting for their batch are dropped with the peers
+    for (auto& peer : m_peers)
+    {
+        peer.second.flushEvent.Cancel();
+    }
+    m_peers.clear();
+}
+
+void
+EchoReflector::HandleRead(Ptr<Socket> socket)
+{
+    NS_LOG_FUNCTION(this << socket);
+    // scratch shared by all reflectors, HandleRead does not nest
+    static std::vector<Address> partial;
+    Ptr<Packet> packet;
+    Address from;
+    int64_t now = Simulator::Now().GetNanoSeconds();
+    while ((packet = socket->RecvFrom(from)))
+    {
+        m_rxTrace(packet);
+        if (!EchoTimestampHeader::IsStamped(packet))
+        {
+            if (m_echoUnstamped)
+            {
+                packet->RemoveAllPacketTags();
+                packet->RemoveAllByteTags();
+                Reply(socket, packet, from);
+            }
+            continue;
+        }
+
+        m_requests++;
+        EchoTimestampHeader request;
+        packet->PeekHeader(request);
+        SocketIpTosTag tos;
+        uint8_t ecn = packet->PeekPacketTag(tos) ? tos.GetTos() & 0x3 : 0;
+        Peer& peer = m_peers[from];
+        if (peer.received++ % m_sampleEvery != 0)
+        {
+            continue;
+        }
+        for (EchoTimestampHeader::Stamp stamp : request.GetStamps())
+        {
+            if (peer.pending.GetStamps().empty())
+            {
+                // a new batch starts
+                if (m_batchTimeout.IsZero())
+                {
+                    partial.push_back(from);
+                }
+                else
+                {
+                    peer.flushEvent = Simulator::Schedule(m_batchTimeout,
+                                                          &EchoReflector::Flush,
+                                                          this,
+                                                          socket,
+                                                          from);
+                }
+            }
+            stamp.reflectorRx = now;
+            stamp.ecn = ecn;
+            peer.pending.AddStamp(stamp);
+            if (peer.pending.GetStamps().size() == m_batchSize)
+            {
+                Flush(socket, from);
+            }
+        }
+    }
+
+    // partial batches of the requests read together, the full ones are gone
+    for (const Address& address : partial)
+    {
+        Flush(socket, address);
+    }
+    partial.clear();
+}
+
+void
+EchoReflector::Flush(Ptr<Socket> socket, Address from)
+{
+    NS_LOG_FUNCTION(this << from);
+    Peer& peer = m_peers[from];
+    peer.flushEvent.Cancel();
+    if (peer.pending.GetStamps().empty())
+    {
+        return;
+    }
+    m_reflected += peer.pending.GetStamps().size();
+    peer.pending.SetReflectorTx(Simulator::Now());
+    Ptr<Packet> reply = Create<Packet>(m_replySize);
+    reply->AddHeader(peer.pending);
+    peer.pending.Clear();
+    Reply(socket, reply, from);
+}
+
+void
+EchoReflector::Reply(Ptr<Socket> socket, Ptr<Packet> packet, const Address& to)
+{
+    m_txTrace(packet);
+    socket->SendTo(packet, 0, to);
+    m_replies++;
+    NS_LOG_INFO("At time " << Simulator::Now().As(Time::S) << " reflector sent "
+                           << packet->GetSize() << " bytes");
+}
+
+} // namespace ns3
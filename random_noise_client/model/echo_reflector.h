@@ -0,0 +1,132 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ECHO_REFLECTOR_H
+#define ECHO_REFLECTOR_H
+
+#include "ns3/address.h"
+#include "ns3/application.h"
+#include "ns3/echo_timestamp_header.h"
+#include "ns3/event-id.h"
+#include "ns3/ptr.h"
+#include "ns3/traced-callback.h"
+
+#include <map>
+
+namespace ns3
+{
+
+class Socket;
+class Packet;
+
+/**
+ * \ingroup randomnoise
+ * \brief Echo server returning the timestamps of RandomNoiseClient requests.
+ *
+ * Requests starting with an EchoTimestampHeader are stamped with their
+ * receive time and the ECN bits they arrived with, and reflected to their
+ * sender, keeping the client's sequence number. One request of every SampleEvery is reflected, and up to BatchSize
+ * stamps of the same sender share one reply, whose payload is ReplySize
+ * bytes instead of the request's. Other packets are echoed unchanged, like
+ * UdpEchoServer does, unless EchoUnstamped is false.
+ */
+class EchoReflector : public Application
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    EchoReflector();
+
+    ~EchoReflector() override;
+
+    /**
+     * \return the stamped requests received
+     */
+    uint64_t GetRequests() const;
+
+    /**
+     * \return the stamps sent back, at most one per request
+     */
+    uint64_t GetReflected() const;
+
+    /**
+     * \return the replies sent, stamped or echoed
+     */
+    uint64_t GetReplies() const;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    /// Requests of one sender waiting to be reflected
+    struct Peer
+    {
+        EchoTimestampHeader pending; //!< Stamps of the next reply
+        uint32_t received{0};        //!< Stamped requests received, for sampling
+        EventId flushEvent;          //!< Sends a partial batch after BatchTimeout
+    };
+
+    void StartApplication() override;
+    void StopApplication() override;
+
+    /**
+     * \brief Handle the packets queued at a socket.
+     * \param socket the socket the packets were received to
+     */
+    void HandleRead(Ptr<Socket> socket);
+
+    /**
+     * \brief Send the pending stamps of a sender in one reply.
+     * \param socket the socket to reply through
+     * \param from the sender
+     */
+    void Flush(Ptr<Socket> socket, Address from);
+
+    /**
+     * \param socket the socket to reply through
+     * \param packet the reply
+     * \param to the destination
+     */
+    void Reply(Ptr<Socket> socket, Ptr<Packet> packet, const Address& to);
+
+    uint16_t m_port;        //!< Port on which we listen for incoming packets
+    uint32_t m_sampleEvery; //!< One stamped request of every m_sampleEvery is reflected
+    uint32_t m_batchSize;   //!< Stamps per reply
+    Time m_batchTimeout;    //!< Wait for a partial batch, zero to send it after each read
+    uint32_t m_replySize;   //!< Payload bytes of stamped replies
+    bool m_echoUnstamped;   //!< Echo packets without timestamps
+
+    Ptr<Socket> m_socket;            //!< IPv4 socket
+    Ptr<Socket> m_socket6;           //!< IPv6 socket
+    std::map<Address, Peer> m_peers; //!< Senders of stamped requests
+
+    uint64_t m_requests;  //!< Stamped requests received
+    uint64_t m_reflected; //!< Stamps sent back
+    uint64_t m_replies;   //!< Packets sent
+
+    /// Callbacks for tracing the packet Rx events
+    TracedCallback<Ptr<const Packet>> m_rxTrace;
+
+    /// Callbacks for tracing the packet Tx events
+    TracedCallback<Ptr<const Packet>> m_txTrace;
+};
+
+} // namespace ns3
+
+#endif /* ECHO_REFLECTOR_H */
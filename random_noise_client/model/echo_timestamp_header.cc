@@ -0,0 +1,134 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "echo_timestamp_header.h"
+
+#include "ns3/abort.h"
+
+namespace ns3
+{
+
+NS_OBJECT_ENSURE_REGISTERED(EchoTimestampHeader);
+
+TypeId
+EchoTimestampHeader::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::EchoTimestampHeader")
+                            .SetParent<Header>()
+                            .SetGroupName("Applications")
+                            .AddConstructor<EchoTimestampHeader>();
+    return tid;
+}
+
+TypeId
+EchoTimestampHeader::GetInstanceTypeId() const
+{
+    return GetTypeId();
+}
+
+void
+EchoTimestampHeader::Print(std::ostream& os) const
+{
+    os << "reflectorTx=" << m_reflectorTx;
+    for (const Stamp& stamp : m_stamps)
+    {
+        os << " (seq=" << stamp.seq << " clientTx=" << stamp.clientTx
+           << " reflectorRx=" << stamp.reflectorRx << " ecn=" << +stamp.ecn << ")";
+    }
+}
+
+uint32_t
+EchoTimestampHeader::GetSerializedSize() const
+{
+    return FIXED_SIZE + STAMP_SIZE * m_stamps.size();
+}
+
+void
+EchoTimestampHeader::Serialize(Buffer::Iterator start) const
+{
+    start.WriteHtonU16(MAGIC);
+    start.WriteU8(m_stamps.size());
+    start.WriteHtonU64(m_reflectorTx);
+    for (const Stamp& stamp : m_stamps)
+    {
+        start.WriteHtonU32(stamp.seq);
+        start.WriteHtonU64(stamp.clientTx);
+        start.WriteHtonU64(stamp.reflectorRx);
+        start.WriteU8(stamp.ecn);
+    }
+}
+
+uint32_t
+EchoTimestampHeader::Deserialize(Buffer::Iterator start)
+{
+    NS_ABORT_MSG_IF(start.ReadNtohU16() != MAGIC, "Not an EchoTimestampHeader");
+    uint32_t count = start.ReadU8();
+    m_reflectorTx = start.ReadNtohU64();
+    m_stamps.resize(count);
+    for (Stamp& stamp : m_stamps)
+    {
+        stamp.seq = start.ReadNtohU32();
+        stamp.clientTx = start.ReadNtohU64();
+        stamp.reflectorRx = start.ReadNtohU64();
+        stamp.ecn = start.ReadU8();
+    }
+    return GetSerializedSize();
+}
+
+bool
+EchoTimestampHeader::IsStamped(Ptr<const Packet> packet)
+{
+    uint8_t prefix[3];
+    if (packet->GetSize() < FIXED_SIZE + STAMP_SIZE || packet->CopyData(prefix, 3) != 3)
+    {
+        return false;
+    }
+    return (prefix[0] << 8 | prefix[1]) == MAGIC && prefix[2] > 0 &&
+           packet->GetSize() >= FIXED_SIZE + STAMP_SIZE * prefix[2];
+}
+
+void
+EchoTimestampHeader::AddStamp(const Stamp& stamp)
+{
+    NS_ABORT_MSG_IF(m_stamps.size() == MAX_STAMPS, "Too many stamps in one header");
+    m_stamps.push_back(stamp);
+}
+
+const std::vector<EchoTimestampHeader::Stamp>&
+EchoTimestampHeader::GetStamps() const
+{
+    return m_stamps;
+}
+
+void
+EchoTimestampHeader::Clear()
+{
+    m_stamps.clear();
+    m_reflectorTx = 0;
+}
+
+void
+EchoTimestampHeader::SetReflectorTx(Time time)
+{
+    m_reflectorTx = time.GetNanoSeconds();
+}
+
+Time
+EchoTimestampHeader::GetReflectorTx() const
+{
+    return NanoSeconds(m_reflectorTx);
+}
+
+} // namespace ns3
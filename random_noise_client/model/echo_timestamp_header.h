@@ -0,0 +1,111 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ECHO_TIMESTAMP_HEADER_H
+#define ECHO_TIMESTAMP_HEADER_H
+
+#include "ns3/header.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup randomnoise
+ * \brief Timestamps exchanged between a RandomNoiseClient and an EchoReflector.
+ *
+ * A request carries one Stamp with the client's sequence number and send
+ * time. A reply carries the stamps of up to 255 reflected requests, each
+ * completed with its receive time at the reflector, and the time the reply
+ * left the reflector and the ECN codepoint each request arrived with.
+ *
+ * \verbatim
+ *   magic (2) | count (1) | reflectorTx (8) |
+ *   count x [seq (4) | clientTx (8) | reflectorRx (8) | ecn (1)]
+ * \endverbatim
+ *
+ * Times are in nanoseconds of the simulation clock, which every node
+ * shares, so reflectorRx - clientTx is the one-way forward delay.
+ */
+class EchoTimestampHeader : public Header
+{
+  public:
+    /// Timestamps of one request
+    struct Stamp
+    {
+        uint32_t seq{0};        //!< Sequence number given by the client
+        int64_t clientTx{0};    //!< Send time at the client (ns)
+        int64_t reflectorRx{0}; //!< Receive time at the reflector (ns), 0 in requests
+        uint8_t ecn{0};         //!< ECN bits of the request at the reflector, 0 in requests
+    };
+
+    static constexpr uint16_t MAGIC = 0x4d54;   //!< "MT", tells stamped packets from others
+    static constexpr uint32_t MAX_STAMPS = 255; //!< Stamps per header
+    static constexpr uint32_t STAMP_SIZE = 21;  //!< Serialized bytes per stamp
+    static constexpr uint32_t FIXED_SIZE = 11;  //!< Serialized bytes besides the stamps
+
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+    TypeId GetInstanceTypeId() const override;
+    void Print(std::ostream& os) const override;
+    uint32_t GetSerializedSize() const override;
+    void Serialize(Buffer::Iterator start) const override;
+    uint32_t Deserialize(Buffer::Iterator start) override;
+
+    /**
+     * \param packet a received packet
+     * \return true if the packet starts with an EchoTimestampHeader
+     */
+    static bool IsStamped(Ptr<const Packet> packet);
+
+    /**
+     * \param stamp the stamp to append
+     */
+    void AddStamp(const Stamp& stamp);
+
+    /**
+     * \return the stamps, in the order they were added
+     */
+    const std::vector<Stamp>& GetStamps() const;
+
+    /**
+     * \brief Forget all the stamps.
+     */
+    void Clear();
+
+    /**
+     * \param time the time the reply leaves the reflector
+     */
+    void SetReflectorTx(Time time);
+
+    /**
+     * \return the time the reply left the reflector, zero in requests
+     */
+    Time GetReflectorTx() const;
+
+  private:
+    std::vector<Stamp> m_stamps; //!< Stamps carried
+    int64_t m_reflectorTx{0};    //!< Send time of the reply (ns)
+};
+
+} // namespace ns3
+
+#endif /* ECHO_TIMESTAMP_HEADER_H */
@@ -0,0 +1,164 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/flow_stats_sampler.h"
+
+#include "ns3/log.h"
+#include "ns3/masticc_profiler.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("FlowStatsSampler");
+
+NS_OBJECT_ENSURE_REGISTERED(FlowStatsSampler);
+
+TypeId
+FlowStatsSampler::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::FlowStatsSampler")
+            .SetParent<Object>()
+            .SetGroupName("Applications")
+            .AddConstructor<FlowStatsSampler>()
+            .AddAttribute("Interval",
+                          "Time between two samples of the flow statistics",
+                          TimeValue(MilliSeconds(100)),
+                          MakeTimeAccessor(&FlowStatsSampler::m_interval),
+                          MakeTimeChecker())
+            .AddAttribute("OutputFile",
+                          "CSV file the per-flow time series is written to",
+                          StringValue("flows.csv"),
+                          MakeStringAccessor(&FlowStatsSampler::m_outputFile),
+                          MakeStringChecker());
+    return tid;
+}
+
+FlowStatsSampler::FlowStatsSampler()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+FlowStatsSampler::~FlowStatsSampler()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+FlowStatsSampler::SetFlowMonitor(Ptr<FlowMonitor> monitor, Ptr<Ipv4FlowClassifier> classifier)
+{
+    NS_LOG_FUNCTION(this << monitor << classifier);
+    m_monitor = monitor;
+    m_classifier = classifier;
+}
+
+void
+FlowStatsSampler::Start()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT_MSG(m_monitor, "FlowStatsSampler has no flow monitor");
+    m_output.open(m_outputFile);
+    if (!m_output.is_open())
+    {
+        NS_FATAL_ERROR("Could not create " << m_outputFile);
+    }
+    m_output << "time,flow,src,dst,src_port,dst_port,throughput_bps,delay_s,jitter_s,"
+                "lost_packets,loss_ratio\n";
+    // when started late, e.g. after a warm-up, the first interval starts now
+    m_last.clear();
+    for (const auto& [flowId, stats] : m_monitor->GetFlowStats())
+    {
+        Snapshot& last = m_last[flowId];
+        last.txPackets = stats.txPackets;
+        last.rxPackets = stats.rxPackets;
+        last.rxBytes = stats.rxBytes;
+        last.lostPackets = stats.lostPackets;
+        last.delaySum = stats.delaySum;
+        last.jitterSum = stats.jitterSum;
+    }
+    m_sampleEvent = Simulator::Schedule(m_interval, &FlowStatsSampler::Sample, this);
+}
+
+void
+FlowStatsSampler::Stop()
+{
+    NS_LOG_FUNCTION(this);
+    Simulator::Cancel(m_sampleEvent);
+    if (m_output.is_open())
+    {
+        m_output.close();
+    }
+}
+
+void
+FlowStatsSampler::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    Stop();
+    m_monitor = nullptr;
+    m_classifier = nullptr;
+    m_last.clear();
+    Object::DoDispose();
+}
+
+void
+FlowStatsSampler::Sample()
+{
+    NS_LOG_FUNCTION(this);
+    MASTICC_PROFILE_SCOPE(FLOW_SAMPLE);
+    m_monitor->CheckForLostPackets();
+    double now = Simulator::Now().GetSeconds();
+    double interval = m_interval.GetSeconds();
+
+    for (const auto& [flowId, stats] : m_monitor->GetFlowStats())
+    {
+        Snapshot& last = m_last[flowId];
+        uint32_t txPackets = stats.txPackets - last.txPackets;
+        uint32_t rxPackets = stats.rxPackets - last.rxPackets;
+        uint32_t lostPackets = stats.lostPackets - last.lostPackets;
+        if (txPackets == 0 && rxPackets == 0 && lostPackets == 0)
+        {
+            continue;
+        }
+
+        double throughput = (stats.rxBytes - last.rxBytes) * 8.0 / interval;
+        double delay = 0;
+        double jitter = 0;
+        if (rxPackets > 0)
+        {
+            delay = (stats.delaySum - last.delaySum).GetSeconds() / rxPackets;
+            jitter = (stats.jitterSum - last.jitterSum).GetSeconds() / rxPackets;
+        }
+        double lossRatio = txPackets > 0 ? static_cast<double>(lostPackets) / txPackets : 0;
+
+        Ipv4FlowClassifier::FiveTuple tuple = m_classifier->FindFlow(flowId);
+        m_output << now << ',' << flowId << ',' << tuple.sourceAddress << ','
+                 << tuple.destinationAddress << ',' << tuple.sourcePort << ','
+                 << tuple.destinationPort << ',' << throughput << ',' << delay << ',' << jitter
+                 << ',' << lostPackets << ',' << lossRatio << '\n';
+
+        last.txPackets = stats.txPackets;
+        last.rxPackets = stats.rxPackets;
+        last.rxBytes = stats.rxBytes;
+        last.lostPackets = stats.lostPackets;
+        last.delaySum = stats.delaySum;
+        last.jitterSum = stats.jitterSum;
+    }
+
+    m_sampleEvent = Simulator::Schedule(m_interval, &FlowStatsSampler::Sample, this);
+}
+
+} // namespace ns3
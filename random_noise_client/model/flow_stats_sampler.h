@@ -0,0 +1,101 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FLOW_STATS_SAMPLER_H
+#define FLOW_STATS_SAMPLER_H
+
+#include "ns3/event-id.h"
+#include "ns3/flow-monitor.h"
+#include "ns3/ipv4-flow-classifier.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+
+#include <fstream>
+#include <map>
+
+namespace ns3
+{
+
+/**
+ * \ingroup randomnoise
+ * \brief Periodically turns FlowMonitor counters into a per-flow time series.
+ *
+ * Every Interval the sampler reads the cumulative FlowMonitor statistics,
+ * computes what changed since the previous sample and appends one CSV row
+ * per active flow: throughput, mean delay, mean jitter and losses over the
+ * interval. Only the previous sample is kept, so memory does not grow with
+ * the simulated time and there is no XML to parse after the run.
+ */
+class FlowStatsSampler : public Object
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    FlowStatsSampler();
+    ~FlowStatsSampler() override;
+
+    /**
+     * \brief Set the monitor to sample.
+     * \param monitor the flow monitor
+     * \param classifier the classifier of the monitor, to name the flows
+     */
+    void SetFlowMonitor(Ptr<FlowMonitor> monitor, Ptr<Ipv4FlowClassifier> classifier);
+
+    /**
+     * \brief Open the output file and schedule the first sample.
+     */
+    void Start();
+
+    /**
+     * \brief Cancel sampling and close the output file.
+     */
+    void Stop();
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    /// FlowMonitor counters of a flow at the previous sample
+    struct Snapshot
+    {
+        uint32_t txPackets{0};   //!< Packets sent
+        uint32_t rxPackets{0};   //!< Packets received
+        uint64_t rxBytes{0};     //!< Bytes received
+        uint32_t lostPackets{0}; //!< Packets considered lost
+        Time delaySum;           //!< Sum of end-to-end delays
+        Time jitterSum;          //!< Sum of delay variations
+    };
+
+    /**
+     * \brief Write one row per flow and schedule the next sample.
+     */
+    void Sample();
+
+    Time m_interval;                      //!< Sampling period
+    std::string m_outputFile;             //!< CSV file name
+    Ptr<FlowMonitor> m_monitor;           //!< Sampled monitor
+    Ptr<Ipv4FlowClassifier> m_classifier; //!< Flow classifier of the monitor
+    std::map<FlowId, Snapshot> m_last;    //!< Counters at the previous sample
+    std::ofstream m_output;               //!< Output stream
+    EventId m_sampleEvent;                //!< Next sample
+};
+
+} // namespace ns3
+
+#endif /* FLOW_STATS_SAMPLER_H */
@@ -0,0 +1,187 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/header_summary.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/masticc_profiler.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <string.h>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("HeaderSummary");
+
+static_assert(sizeof(HeaderSummaryRecord) == 16, "HeaderSummaryRecord must not be padded");
+static_assert(sizeof(HeaderSummaryFileHeader) == 40, "HeaderSummaryFileHeader must not be padded");
+
+namespace
+{
+const char HEADER_SUMMARY_MAGIC[8] = {'M', 'S', 'T', 'C', 'H', 'S', '0', '1'};
+} // namespace
+
+HeaderSummaryWriter::HeaderSummaryWriter(const std::string& filename,
+                                         uint64_t byteBudget,
+                                         uint32_t snapLen)
+{
+    NS_LOG_FUNCTION(this << filename << byteBudget << snapLen);
+    memcpy(m_header.magic, HEADER_SUMMARY_MAGIC, sizeof(m_header.magic));
+    m_header.recordSize = sizeof(HeaderSummaryRecord) + snapLen;
+    m_header.snapLen = snapLen;
+    m_header.capacity = byteBudget / m_header.recordSize;
+    m_header.head = 0;
+    m_header.written = 0;
+    NS_ABORT_MSG_IF(byteBudget > 0 && m_header.capacity == 0,
+                    "Byte budget " << byteBudget << " is smaller than one record");
+
+    // PPP header (with address and control), IPv4 header, snapLen bytes
+    m_buffer.resize(4 + std::max<uint32_t>(20, snapLen));
+
+    m_file.open(filename, std::ios::binary | std::ios::trunc);
+    if (!m_file.is_open())
+    {
+        NS_FATAL_ERROR("Could not create " << filename);
+    }
+    WriteFileHeader();
+}
+
+HeaderSummaryWriter::~HeaderSummaryWriter()
+{
+    Close();
+}
+
+void
+HeaderSummaryWriter::Write(Ptr<const Packet> packet)
+{
+    MASTICC_PROFILE_SCOPE(TRACE);
+    uint32_t length = packet->CopyData(m_buffer.data(), m_buffer.size());
+    const uint8_t* ip = m_buffer.data();
+    if (length >= 4 && ip[0] == 0xff && ip[1] == 0x03)
+    {
+        ip += 2;
+        length -= 2;
+    }
+    if (length >= 2 && ip[0] == 0x00 && ip[1] == 0x21)
+    {
+        ip += 2;
+        length -= 2;
+    }
+    if (length < 20 || (ip[0] >> 4) != 4)
+    {
+        return;
+    }
+
+    HeaderSummaryRecord record;
+    record.time = Simulator::Now().GetNanoSeconds();
+    record.src = (ip[12] << 24) | (ip[13] << 16) | (ip[14] << 8) | ip[15];
+    record.id = (ip[4] << 8) | ip[5];
+    record.length = (ip[2] << 8) | ip[3];
+
+    if (m_header.capacity > 0 && m_header.head == m_header.capacity)
+    {
+        // budget used up: wrap and overwrite the oldest records
+        m_file.seekp(sizeof(HeaderSummaryFileHeader));
+        m_header.head = 0;
+    }
+    m_file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    if (m_header.snapLen > 0)
+    {
+        uint32_t kept = std::min(length, m_header.snapLen);
+        m_file.write(reinterpret_cast<const char*>(ip), kept);
+        for (uint32_t i = kept; i < m_header.snapLen; i++)
+        {
+            m_file.put(0);
+        }
+    }
+    m_header.head++;
+    m_header.written++;
+}
+
+void
+HeaderSummaryWriter::Close()
+{
+    if (m_file.is_open())
+    {
+        NS_LOG_FUNCTION(this);
+        m_file.seekp(0);
+        WriteFileHeader();
+        m_file.close();
+    }
+}
+
+void
+HeaderSummaryWriter::WriteFileHeader()
+{
+    m_file.write(reinterpret_cast<const char*>(&m_header), sizeof(m_header));
+}
+
+HeaderSummaryReader::HeaderSummaryReader()
+    : m_count(0),
+      m_first(0),
+      m_read(0)
+{
+}
+
+bool
+HeaderSummaryReader::Open(const std::string& path)
+{
+    NS_LOG_FUNCTION(this << path);
+    if (!m_file.Open(path) || m_file.GetSize() < sizeof(HeaderSummaryFileHeader))
+    {
+        return false;
+    }
+    memcpy(&m_header, m_file.GetData(), sizeof(m_header));
+    if (memcmp(m_header.magic, HEADER_SUMMARY_MAGIC, sizeof(m_header.magic)) != 0 ||
+        m_header.recordSize < sizeof(HeaderSummaryRecord))
+    {
+        return false;
+    }
+    m_file.AdviseSequential();
+
+    bool wrapped = m_header.capacity > 0 && m_header.written > m_header.capacity;
+    m_count = wrapped ? m_header.capacity : m_header.written;
+    m_first = wrapped ? m_header.head % m_header.capacity : 0;
+    m_read = 0;
+
+    uint64_t stored = (m_file.GetSize() - sizeof(HeaderSummaryFileHeader)) / m_header.recordSize;
+    if (stored < m_count)
+    {
+        NS_LOG_WARN(path << " is truncated, was the writer closed?");
+        m_count = stored;
+        m_first = 0;
+    }
+    return true;
+}
+
+bool
+HeaderSummaryReader::Next(HeaderSummaryRecord& record)
+{
+    if (m_read == m_count)
+    {
+        return false;
+    }
+    uint64_t slot = (m_first + m_read) % m_count;
+    memcpy(&record,
+           m_file.GetData() + sizeof(HeaderSummaryFileHeader) + slot * m_header.recordSize,
+           sizeof(record));
+    m_read++;
+    return true;
+}
+
+} // namespace ns3
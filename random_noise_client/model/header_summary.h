@@ -0,0 +1,137 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef HEADER_SUMMARY_H
+#define HEADER_SUMMARY_H
+
+#include "ns3/mapped_file.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+
+#include <fstream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+class Packet;
+
+/**
+ * \ingroup randomnoise
+ * \brief File header of a header summary capture.
+ *
+ * The header is followed by a ring of fixed-size records: a
+ * HeaderSummaryRecord and then snapLen bytes of the packet, starting at the
+ * IPv4 header. When the byte budget is reached the oldest records are
+ * overwritten and head points at the oldest one.
+ */
+struct HeaderSummaryFileHeader
+{
+    char magic[8];        //!< "MSTCHS01"
+    uint32_t recordSize;  //!< Bytes per record, summary plus snapLen
+    uint32_t snapLen;     //!< Packet bytes stored after each summary
+    uint64_t capacity;    //!< Records that fit in the budget, 0 if unbounded
+    uint64_t head;        //!< Index of the next record slot to write
+    uint64_t written;     //!< Records written in total, including overwritten ones
+};
+
+/**
+ * \ingroup randomnoise
+ * \brief Summary of one captured IPv4 packet, all a latency analysis needs.
+ */
+struct HeaderSummaryRecord
+{
+    uint64_t time;   //!< Capture time (ns)
+    uint32_t src;    //!< IPv4 source, host byte order
+    uint16_t id;     //!< IPv4 identification
+    uint16_t length; //!< IPv4 total length
+};
+
+/**
+ * \ingroup randomnoise
+ * \brief Writes header summaries of the packets seen by a device.
+ *
+ * A fraction of the size of a pcap with full payloads, and bounded by a
+ * byte budget. Non-IPv4 packets are not recorded.
+ */
+class HeaderSummaryWriter : public SimpleRefCount<HeaderSummaryWriter>
+{
+  public:
+    /**
+     * \param filename the file to create
+     * \param byteBudget maximum size of the record area, 0 for no limit
+     * \param snapLen packet bytes to keep after each summary
+     */
+    HeaderSummaryWriter(const std::string& filename, uint64_t byteBudget, uint32_t snapLen);
+    ~HeaderSummaryWriter();
+
+    /**
+     * \brief Record a packet, as seen by a sniffer trace source.
+     * \param packet the packet, with or without its PPP header
+     */
+    void Write(Ptr<const Packet> packet);
+
+    /**
+     * \brief Write the final file header and close the file.
+     */
+    void Close();
+
+  private:
+    /**
+     * \brief Write the file header at the start of the file.
+     */
+    void WriteFileHeader();
+
+    std::ofstream m_file;             //!< Output file
+    HeaderSummaryFileHeader m_header; //!< Header kept up to date in memory
+    std::vector<uint8_t> m_buffer;    //!< Scratch: packet bytes
+};
+
+/**
+ * \ingroup randomnoise
+ * \brief Reads a header summary capture in time order.
+ */
+class HeaderSummaryReader
+{
+  public:
+    HeaderSummaryReader();
+
+    /**
+     * \param path the capture file
+     * \return false if the file is missing or not a header summary capture
+     */
+    bool Open(const std::string& path);
+
+    /**
+     * \brief Get the next record, oldest first.
+     * \param record filled in on success
+     * \return false once every record was read
+     */
+    bool Next(HeaderSummaryRecord& record);
+
+  private:
+    MappedFile m_file;                //!< The capture
+    HeaderSummaryFileHeader m_header; //!< Copy of the file header
+    uint64_t m_count;                 //!< Records stored in the file
+    uint64_t m_first;                 //!< Slot of the oldest record
+    uint64_t m_read;                  //!< Records returned so far
+};
+
+} // namespace ns3
+
+#endif /* HEADER_SUMMARY_H */
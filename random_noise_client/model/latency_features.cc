@@ -0,0 +1,251 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/latency_features.h"
+
+#include "ns3/assert.h"
+
+#include <algorithm>
+#include <charconv>
+#include <limits>
+
+namespace ns3
+{
+
+namespace
+{
+
+const uint32_t LATENCY_SMOOTH_WINDOW = 4; //!< smooth_data(latencies, 4)
+const uint32_t STATS_WINDOW = 20;         //!< calculate_stats(latencies_smoothed, 20)
+const uint32_t LOSS_WINDOW = 20;          //!< calculate_packet_loss(..., 20)
+const uint64_t HISTORY = 24;              //!< Samples kept behind the next row
+
+/**
+ * \brief Write a double in its shortest round-trip form, like Python's repr.
+ */
+void
+WriteDouble(std::ostream& os, double value)
+{
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    os.write(buffer, result.ptr - buffer);
+}
+
+} // namespace
+
+void
+LatencyFeatureRow::WriteCsvHeader(std::ostream& os)
+{
+    os << "ts,mean_latency,stdev_latency,latencies,latencies_smoothed,first_order_deriv,"
+          "second_order_deriv,packet_loss,bw_ratio\n";
+}
+
+void
+LatencyFeatureRow::WriteCsv(std::ostream& os) const
+{
+    const double values[] = {ts,
+                             meanLatency,
+                             stdevLatency,
+                             latency,
+                             latencySmoothed,
+                             firstOrderDeriv,
+                             secondOrderDeriv,
+                             packetLoss,
+                             bwRatio};
+    for (uint32_t i = 0; i < 9; i++)
+    {
+        if (i != 0)
+        {
+            os << ',';
+        }
+        WriteDouble(os, values[i]);
+    }
+    os << '\n';
+}
+
+LatencyFeatureExtractor::LatencyFeatureExtractor(double bottleneckRate, double lossHorizon)
+    : m_bottleneckRate(bottleneckRate),
+      m_lossHorizon(lossHorizon),
+      m_now(0),
+      m_finished(false),
+      m_sendTime(65536, 0),
+      m_state(65536, 0),
+      m_pendingBits(0),
+      m_firstSample(0),
+      m_nSamples(0),
+      m_nextRow(0)
+{
+}
+
+void
+LatencyFeatureExtractor::AddClientPacket(double t, uint16_t ipId)
+{
+    NS_ASSERT(!m_finished);
+    m_now = std::max(m_now, t);
+
+    if (m_state[ipId] == 0)
+    {
+        m_state[ipId] = 1;
+        m_sendTime[ipId] = t;
+        m_lastSent.push_back(ipId);
+        if (m_lastSent.size() > LOSS_WINDOW)
+        {
+            m_lastSent.pop_front();
+        }
+    }
+    else
+    {
+        // an id seen before is the echo of that packet
+        m_state[ipId] = 2;
+        Sample sample;
+        sample.ts = t;
+        sample.latency = t - m_sendTime[ipId];
+        sample.bits = m_pendingBits;
+        sample.sent.assign(m_lastSent.begin(), m_lastSent.end());
+        m_samples.push_back(std::move(sample));
+        m_pendingBits = 0;
+        m_nSamples++;
+    }
+    Release();
+}
+
+void
+LatencyFeatureExtractor::AddBottleneckPacket(double t, uint32_t bytes)
+{
+    NS_ASSERT(!m_finished);
+    m_now = std::max(m_now, t);
+    m_pendingBits += bytes * 8.0;
+    Release();
+}
+
+void
+LatencyFeatureExtractor::Finish()
+{
+    m_finished = true;
+    Release();
+}
+
+bool
+LatencyFeatureExtractor::PopRow(LatencyFeatureRow& row)
+{
+    if (m_rows.empty())
+    {
+        return false;
+    }
+    row = m_rows.front();
+    m_rows.pop_front();
+    return true;
+}
+
+const LatencyFeatureExtractor::Sample&
+LatencyFeatureExtractor::At(uint64_t index) const
+{
+    NS_ASSERT(index >= m_firstSample && index < m_firstSample + m_samples.size());
+    return m_samples[index - m_firstSample];
+}
+
+double
+LatencyFeatureExtractor::Smooth(uint64_t index, uint32_t window, bool smoothed) const
+{
+    // np.convolve(data, ones(window) / window, 'valid') padded with its first
+    // and last value, so the window is centered and clamped at both ends
+    uint64_t n = m_finished ? m_nSamples : std::numeric_limits<uint64_t>::max();
+    uint64_t count = std::min<uint64_t>(window, n);
+    uint64_t before = window / 2;
+    uint64_t first = index > before ? index - before : 0;
+    first = std::min(first, n - count);
+
+    double sum = 0;
+    for (uint64_t i = first; i < first + count; i++)
+    {
+        sum += smoothed ? Smooth(i, LATENCY_SMOOTH_WINDOW, false) : At(i).latency;
+    }
+    return sum / count;
+}
+
+double
+LatencyFeatureExtractor::FirstDerivative(uint64_t index) const
+{
+    if (index == 0)
+    {
+        return 0;
+    }
+    return (Smooth(index, LATENCY_SMOOTH_WINDOW, false) -
+            Smooth(index - 1, LATENCY_SMOOTH_WINDOW, false)) /
+           (At(index).ts - At(index - 1).ts);
+}
+
+void
+LatencyFeatureExtractor::Release()
+{
+    while (m_nextRow < m_nSamples)
+    {
+        uint64_t f = m_nextRow;
+        const Sample& sample = At(f);
+        if (!m_finished)
+        {
+            // the 20-sample mean looks up to 10 samples ahead of the row
+            uint64_t lookahead = std::max<uint64_t>(f, STATS_WINDOW / 2) + STATS_WINDOW / 2;
+            if (m_nSamples <= lookahead || m_now - sample.ts < m_lossHorizon)
+            {
+                break;
+            }
+        }
+
+        LatencyFeatureRow row;
+        row.ts = sample.ts;
+        row.latency = sample.latency;
+        row.latencySmoothed = Smooth(f, LATENCY_SMOOTH_WINDOW, false);
+        row.meanLatency = Smooth(f, STATS_WINDOW, true);
+        row.stdevLatency = row.latencySmoothed - row.meanLatency;
+        row.firstOrderDeriv = FirstDerivative(f);
+        // np.concatenate(([0, 0], diff(d1) / diff(ts))) is shifted by one sample
+        row.secondOrderDeriv =
+            f < 2 ? 0
+                  : (FirstDerivative(f - 1) - FirstDerivative(f - 2)) / (At(f - 1).ts - At(f - 2).ts);
+
+        uint32_t lost = 0;
+        for (uint16_t id : sample.sent)
+        {
+            if (m_state[id] != 2)
+            {
+                lost++;
+            }
+        }
+        row.packetLoss = sample.sent.empty() ? 0 : static_cast<double>(lost) / sample.sent.size();
+
+        if (f == 0)
+        {
+            // process_pcap.py compares the first echo with the last one and
+            // always ends up with an empty interval here
+            row.bwRatio = 1;
+        }
+        else
+        {
+            double dt = sample.ts - At(f - 1).ts;
+            double occupied = dt > 0 ? sample.bits / dt / m_bottleneckRate : (sample.bits > 0);
+            row.bwRatio = 1 - std::min(occupied, 1.0);
+        }
+        m_rows.push_back(row);
+        m_nextRow++;
+
+        while (m_firstSample + HISTORY < m_nextRow)
+        {
+            m_samples.pop_front();
+            m_firstSample++;
+        }
+    }
+}
+
+} // namespace ns3
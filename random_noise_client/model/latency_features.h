@@ -0,0 +1,164 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LATENCY_FEATURES_H
+#define LATENCY_FEATURES_H
+
+#include <deque>
+#include <ostream>
+#include <stdint.h>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup randomnoise
+ * \brief One row of the training data set (a line of latency_data.csv).
+ */
+struct LatencyFeatureRow
+{
+    double ts;               //!< Echo receive time (s)
+    double meanLatency;      //!< 20-sample centered mean of latenciesSmoothed
+    double stdevLatency;     //!< latenciesSmoothed minus meanLatency
+    double latency;          //!< Round trip time of this echo (s)
+    double latencySmoothed;  //!< 4-sample centered mean of latency
+    double firstOrderDeriv;  //!< d latencySmoothed / dt
+    double secondOrderDeriv; //!< d firstOrderDeriv / dt, one sample behind
+    double packetLoss;       //!< Fraction of the last 20 sent packets never echoed
+    double bwRatio;          //!< Free fraction of the bottleneck since the previous echo
+
+    /**
+     * \brief Write the CSV header, in the column order of process_pcap.py.
+     * \param os the output stream
+     */
+    static void WriteCsvHeader(std::ostream& os);
+
+    /**
+     * \brief Write this row as one CSV line.
+     * \param os the output stream
+     */
+    void WriteCsv(std::ostream& os) const;
+};
+
+/**
+ * \ingroup randomnoise
+ * \brief Streaming computation of the process_pcap.py features.
+ *
+ * Packets seen by the adaptive client and packets sent over the bottleneck
+ * are fed in time order. A client packet whose IP id was already seen is the
+ * echo of an earlier one, exactly as in process_pcap.py. Rows are produced
+ * with a fixed lag (the centered smoothing windows look a few samples ahead)
+ * and memory stays bounded regardless of the trace length.
+ *
+ * process_pcap.py decides packet loss with knowledge of the whole trace. Here
+ * a packet counts as lost if its echo has not arrived within the loss
+ * horizon, which gives the same values whenever echoes return within it.
+ */
+class LatencyFeatureExtractor
+{
+  public:
+    /**
+     * \param bottleneckRate capacity of the bottleneck link (bit/s)
+     * \param lossHorizon time to wait for an echo before a packet counts as lost (s)
+     */
+    LatencyFeatureExtractor(double bottleneckRate, double lossHorizon = 1.0);
+
+    /**
+     * \brief Add an IPv4/UDP packet sent or received by the adaptive client.
+     * \param t capture time (s)
+     * \param ipId IPv4 identification field
+     */
+    void AddClientPacket(double t, uint16_t ipId);
+
+    /**
+     * \brief Add a packet crossing the bottleneck towards the server.
+     *
+     * Packets must be added before a client packet with the same or a later
+     * time stamp.
+     *
+     * \param t capture time (s)
+     * \param bytes IPv4 packet size
+     */
+    void AddBottleneckPacket(double t, uint32_t bytes);
+
+    /**
+     * \brief Mark the end of the input so the remaining rows are released.
+     */
+    void Finish();
+
+    /**
+     * \brief Get the next completed row.
+     * \param row filled in on success
+     * \return true if a row was available
+     */
+    bool PopRow(LatencyFeatureRow& row);
+
+  private:
+    /// Per-echo sample, kept until no pending row looks at it anymore
+    struct Sample
+    {
+        double ts;                  //!< Receive time
+        double latency;             //!< Round trip time
+        double bits;                //!< Bottleneck bits since the previous sample
+        std::vector<uint16_t> sent; //!< Ids of the last sent packets at receive time
+    };
+
+    /**
+     * \brief Centered moving average as computed by smooth_data() in process_pcap.py.
+     * \param index absolute sample index
+     * \param window averaging window
+     * \param smoothed average the smoothed latency instead of the raw latency
+     * \return the average
+     */
+    double Smooth(uint64_t index, uint32_t window, bool smoothed) const;
+
+    /**
+     * \param index absolute sample index
+     * \return first order derivative of the smoothed latency
+     */
+    double FirstDerivative(uint64_t index) const;
+
+    /**
+     * \param index absolute sample index
+     * \return the sample, which must still be buffered
+     */
+    const Sample& At(uint64_t index) const;
+
+    /**
+     * \brief Move every row that has enough lookahead to the output queue.
+     */
+    void Release();
+
+    double m_bottleneckRate; //!< Bottleneck capacity (bit/s)
+    double m_lossHorizon;    //!< Echo timeout (s)
+    double m_now;            //!< Latest time stamp seen
+    bool m_finished;         //!< True after Finish()
+
+    std::vector<double> m_sendTime; //!< Send time per IP id
+    std::vector<uint8_t> m_state;   //!< 0 unseen, 1 sent, 2 echoed, per IP id
+    std::deque<uint16_t> m_lastSent; //!< Ids of the most recent sent packets
+    double m_pendingBits;            //!< Bottleneck bits since the last echo
+
+    std::deque<Sample> m_samples; //!< Buffered samples
+    uint64_t m_firstSample;       //!< Absolute index of m_samples.front()
+    uint64_t m_nSamples;          //!< Number of samples added so far
+    uint64_t m_nextRow;           //!< Absolute index of the next row to release
+    std::deque<LatencyFeatureRow> m_rows; //!< Released rows
+};
+
+} // namespace ns3
+
+#endif /* LATENCY_FEATURES_H */
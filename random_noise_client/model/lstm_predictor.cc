@@ -0,0 +1,393 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/lstm_predictor.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/online_trainer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <map>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("LstmPredictor");
+
+namespace
+{
+
+/**
+ * \brief Read one "name count" section followed by count values.
+ * \param is the stream to read from
+ * \param path file name, for error messages
+ * \param name the expected section name
+ * \param count the expected number of values
+ * \return the values
+ */
+std::vector<double>
+ReadSection(std::istream& is, const std::string& path, const std::string& name, uint32_t count)
+{
+    std::string section;
+    uint32_t n = 0;
+    if (!(is >> section >> n) || section != name || n != count)
+    {
+        NS_FATAL_ERROR("LSTM model " << path << ": expected section " << name << " with "
+                                     << count << " values");
+    }
+    std::vector<double> values(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (!(is >> values[i]))
+        {
+            NS_FATAL_ERROR("LSTM model " << path << ": truncated section " << name);
+        }
+    }
+    return values;
+}
+
+double
+Sigmoid(double x)
+{
+    return 1.0 / (1.0 + std::exp(-x));
+}
+
+/**
+ * \brief out = W * in + b for a rows x cols row-major W.
+ */
+void
+Dense(const std::vector<double>& w,
+      const std::vector<double>& b,
+      const std::vector<double>& in,
+      std::vector<double>& out)
+{
+    uint32_t rows = b.size();
+    uint32_t cols = in.size();
+    for (uint32_t r = 0; r < rows; r++)
+    {
+        const double* row = &w[r * cols];
+        double sum = b[r];
+        for (uint32_t c = 0; c < cols; c++)
+        {
+            sum += row[c] * in[c];
+        }
+        out[r] = sum;
+    }
+}
+
+} // namespace
+
+LstmModel::LstmModel()
+    : m_inputSize(0),
+      m_hiddenSize(0),
+      m_targetMin(0),
+      m_targetMax(1),
+      m_fcBias(0)
+{
+}
+
+Ptr<const LstmModel>
+LstmModel::Load(const std::string& path, const std::string& scalerPath)
+{
+    NS_LOG_FUNCTION(path << scalerPath);
+    static std::map<std::pair<std::string, std::string>, Ptr<const LstmModel>> models;
+
+    auto it = models.find({path, scalerPath});
+    if (it != models.end())
+    {
+        return it->second;
+    }
+
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        NS_FATAL_ERROR("Could not open LSTM model " << path);
+    }
+    Ptr<LstmModel> model = Ptr<LstmModel>(new LstmModel(), false);
+    model->Read(file, path);
+    if (!scalerPath.empty())
+    {
+        std::ifstream scaler(scalerPath);
+        std::string magic;
+        uint32_t inputs = 0;
+        if (!(scaler >> magic >> inputs) || magic != "scaler")
+        {
+            NS_FATAL_ERROR("Could not read the scaler " << scalerPath);
+        }
+        NS_ABORT_MSG_IF(inputs != model->m_inputSize,
+                        "Scaler " << scalerPath << " has " << inputs << " features, model "
+                                  << path << " takes " << model->m_inputSize);
+        model->ReadScaler(scaler, scalerPath);
+    }
+    NS_LOG_INFO("Loaded LSTM model " << path << " (" << model->m_inputSize << " inputs, "
+                                     << model->m_hiddenSize << " hidden)");
+    models[{path, scalerPath}] = model;
+    return model;
+}
+
+uint32_t
+LstmModel::GetInputSize() const
+{
+    return m_inputSize;
+}
+
+uint32_t
+LstmModel::GetHiddenSize() const
+{
+    return m_hiddenSize;
+}
+
+void
+LstmModel::Read(std::istream& is, const std::string& path)
+{
+    std::string magic;
+    if (!(is >> magic >> m_inputSize >> m_hiddenSize) || magic != "lstm1" || m_inputSize == 0 ||
+        m_hiddenSize == 0)
+    {
+        NS_FATAL_ERROR("LSTM model " << path << " is not an exported LSTM1 model");
+    }
+    uint32_t inputs = m_inputSize;
+    uint32_t hidden = m_hiddenSize;
+
+    ReadScaler(is, path);
+
+    m_weightIh = ReadSection(is, path, "lstm.weight_ih_l0", 4 * hidden * inputs);
+    m_weightHh = ReadSection(is, path, "lstm.weight_hh_l0", 4 * hidden * hidden);
+    m_bias = ReadSection(is, path, "lstm.bias_ih_l0", 4 * hidden);
+    std::vector<double> biasHh = ReadSection(is, path, "lstm.bias_hh_l0", 4 * hidden);
+    for (uint32_t i = 0; i < 4 * hidden; i++)
+    {
+        m_bias[i] += biasHh[i];
+    }
+
+    m_fc1Weight = ReadSection(is, path, "fc_1.weight", hidden * hidden);
+    m_fc1Bias = ReadSection(is, path, "fc_1.bias", hidden);
+    m_fc2Weight = ReadSection(is, path, "fc_2.weight", hidden * hidden);
+    m_fc2Bias = ReadSection(is, path, "fc_2.bias", hidden);
+    m_fc3Weight = ReadSection(is, path, "fc_3.weight", hidden * hidden);
+    m_fc3Bias = ReadSection(is, path, "fc_3.bias", hidden);
+    m_fcWeight = ReadSection(is, path, "fc.weight", hidden);
+    m_fcBias = ReadSection(is, path, "fc.bias", 1)[0];
+}
+
+void
+LstmModel::ReadScaler(std::istream& is, const std::string& path)
+{
+    m_featureMean = ReadSection(is, path, "feature_mean", m_inputSize);
+    m_featureScale = ReadSection(is, path, "feature_scale", m_inputSize);
+    for (auto& scale : m_featureScale)
+    {
+        // StandardScaler leaves constant features unscaled
+        if (scale == 0)
+        {
+            scale = 1;
+        }
+    }
+    std::vector<double> targetRange = ReadSection(is, path, "target_range", 2);
+    m_targetMin = targetRange[0];
+    m_targetMax = targetRange[1];
+}
+
+LstmPredictor::LstmPredictor()
+    : m_model(nullptr),
+      m_windowSize(0),
+      m_windowCount(0),
+      m_windowNext(0),
+      m_headVersion(0)
+{
+}
+
+LstmPredictor::~LstmPredictor()
+{
+}
+
+void
+LstmPredictor::SetModel(Ptr<const LstmModel> model)
+{
+    NS_LOG_FUNCTION(this << model);
+    m_model = model;
+    m_trainer = nullptr;
+    m_head = nullptr;
+    m_headVersion = 0;
+    uint32_t hidden = model->GetHiddenSize();
+    m_h.assign(hidden, 0);
+    m_c.assign(hidden, 0);
+    m_x.assign(model->GetInputSize(), 0);
+    m_gates.assign(4 * hidden, 0);
+    m_layerA.assign(hidden, 0);
+    m_layerB.assign(hidden, 0);
+    SetWindow(m_windowSize);
+}
+
+Ptr<const LstmModel>
+LstmPredictor::GetModel() const
+{
+    return m_model;
+}
+
+void
+LstmPredictor::SetWindow(uint32_t window)
+{
+    NS_LOG_FUNCTION(this << window);
+    m_windowSize = window;
+    m_window.assign(m_model ? window * m_model->GetInputSize() : 0, 0);
+    Reset();
+}
+
+uint32_t
+LstmPredictor::GetWindow() const
+{
+    return m_windowSize;
+}
+
+void
+LstmPredictor::Reset()
+{
+    std::fill(m_h.begin(), m_h.end(), 0);
+    std::fill(m_c.begin(), m_c.end(), 0);
+    m_windowCount = 0;
+    m_windowNext = 0;
+}
+
+void
+LstmPredictor::Step(const double* features)
+{
+    NS_ASSERT_MSG(m_model, "LstmPredictor has no model");
+    const LstmModel& m = *m_model;
+    uint32_t inputs = m.m_inputSize;
+
+    double* x = m_windowSize ? &m_window[m_windowNext * inputs] : m_x.data();
+    for (uint32_t i = 0; i < inputs; i++)
+    {
+        x[i] = (features[i] - m.m_featureMean[i]) / m.m_featureScale[i];
+    }
+    if (m_windowSize == 0)
+    {
+        CellStep(x);
+        return;
+    }
+    m_windowNext = (m_windowNext + 1) % m_windowSize;
+    m_windowCount = std::min(m_windowCount + 1, m_windowSize);
+}
+
+void
+LstmPredictor::CellStep(const double* x)
+{
+    const LstmModel& m = *m_model;
+    uint32_t inputs = m.m_inputSize;
+    uint32_t hidden = m.m_hiddenSize;
+
+    for (uint32_t r = 0; r < 4 * hidden; r++)
+    {
+        const double* wi = &m.m_weightIh[r * inputs];
+        const double* wh = &m.m_weightHh[r * hidden];
+        double sum = m.m_bias[r];
+        for (uint32_t i = 0; i < inputs; i++)
+        {
+            sum += wi[i] * x[i];
+        }
+        for (uint32_t j = 0; j < hidden; j++)
+        {
+            sum += wh[j] * m_h[j];
+        }
+        m_gates[r] = sum;
+    }
+
+    // PyTorch gate order: input, forget, cell, output
+    for (uint32_t j = 0; j < hidden; j++)
+    {
+        double in = Sigmoid(m_gates[j]);
+        double forget = Sigmoid(m_gates[hidden + j]);
+        double cell = std::tanh(m_gates[2 * hidden + j]);
+        double out = Sigmoid(m_gates[3 * hidden + j]);
+        m_c[j] = forget * m_c[j] + in * cell;
+        m_h[j] = out * std::tanh(m_c[j]);
+    }
+}
+
+double
+LstmPredictor::Predict()
+{
+    NS_ASSERT_MSG(m_model, "LstmPredictor has no model");
+    const LstmModel& m = *m_model;
+
+    if (m_windowSize)
+    {
+        // the window from a zero state, oldest sample first, as in training
+        std::fill(m_h.begin(), m_h.end(), 0);
+        std::fill(m_c.begin(), m_c.end(), 0);
+        uint32_t first = (m_windowNext + m_windowSize - m_windowCount) % m_windowSize;
+        for (uint32_t k = 0; k < m_windowCount; k++)
+        {
+            CellStep(&m_window[((first + k) % m_windowSize) * m.m_inputSize]);
+        }
+    }
+
+    // relu -> fc_1 -> fc_2 -> fc_3 -> relu -> fc, as in LSTM1.forward
+    for (uint32_t j = 0; j < m.m_hiddenSize; j++)
+    {
+        m_layerA[j] = std::max(m_h[j], 0.0);
+    }
+    Dense(m.m_fc1Weight, m.m_fc1Bias, m_layerA, m_layerB);
+    Dense(m.m_fc2Weight, m.m_fc2Bias, m_layerB, m_layerA);
+    Dense(m.m_fc3Weight, m.m_fc3Bias, m_layerA, m_layerB);
+    const double* weight = m.m_fcWeight.data();
+    double out = m.m_fcBias;
+    if (m_trainer)
+    {
+        m_trainer->GetHead(m_head, m_headVersion);
+        weight = m_head->weight.data();
+        out = m_head->bias;
+    }
+    for (uint32_t j = 0; j < m.m_hiddenSize; j++)
+    {
+        m_layerB[j] = std::max(m_layerB[j], 0.0);
+        out += weight[j] * m_layerB[j];
+    }
+    return m.m_targetMin + out * (m.m_targetMax - m.m_targetMin);
+}
+
+void
+LstmPredictor::SetTrainer(Ptr<OnlineTrainer> trainer)
+{
+    NS_LOG_FUNCTION(this << trainer);
+    NS_ABORT_MSG_IF(trainer && trainer->GetModel() != m_model,
+                    "The OnlineTrainer fine-tunes another model");
+    m_trainer = trainer;
+    m_head = nullptr;
+    m_headVersion = 0;
+}
+
+const std::vector<double>&
+LstmPredictor::GetHeadInput() const
+{
+    return m_layerB;
+}
+
+uint32_t
+LstmPredictor::GetMemoryUsage() const
+{
+    uint32_t bytes = 0;
+    for (const std::vector<double>* state :
+         {&m_h, &m_c, &m_x, &m_gates, &m_window, &m_layerA, &m_layerB})
+    {
+        bytes += state->capacity() * sizeof(double);
+    }
+    return bytes;
+}
+
+} // namespace ns3
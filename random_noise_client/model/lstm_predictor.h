@@ -0,0 +1,207 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LSTM_PREDICTOR_H
+#define LSTM_PREDICTOR_H
+
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+
+#include <istream>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+class OnlineTrainer;
+struct LstmHead;
+
+/**
+ * \ingroup randomnoise
+ * \brief Read-only weights of the LSTM1 bandwidth model.
+ *
+ * The weights are exported from a trained `LSTM1` (see trainLSTM.py) by
+ * exportLSTM.py, together with the feature scaler and the target range used
+ * during training. A model is immutable once loaded, so a single instance is
+ * shared by every client that uses the same file.
+ */
+class LstmModel : public SimpleRefCount<LstmModel>
+{
+  public:
+    /**
+     * \brief Load a model, reusing an already loaded instance for the same files.
+     * \param path the file written by exportLSTM.py
+     * \param scalerPath scaler.txt written by masticc-dataset-prep, replacing the
+     * scaler of the model file; empty to keep it
+     * \return the shared model
+     */
+    static Ptr<const LstmModel> Load(const std::string& path, const std::string& scalerPath = "");
+
+    /**
+     * \return the number of input features per sample
+     */
+    uint32_t GetInputSize() const;
+
+    /**
+     * \return the size of the LSTM hidden and cell state
+     */
+    uint32_t GetHiddenSize() const;
+
+  private:
+    friend class LstmPredictor;
+    friend class OnlineTrainer;
+
+    LstmModel();
+
+    /**
+     * \brief Parse the exported text format.
+     * \param is the stream to read from
+     * \param path file name, for error messages
+     */
+    void Read(std::istream& is, const std::string& path);
+
+    /**
+     * \brief Parse the feature_mean, feature_scale and target_range sections.
+     * \param is the stream to read from
+     * \param path file name, for error messages
+     */
+    void ReadScaler(std::istream& is, const std::string& path);
+
+    uint32_t m_inputSize;  //!< Number of input features
+    uint32_t m_hiddenSize; //!< Size of the hidden and cell state
+
+    std::vector<double> m_featureMean;  //!< StandardScaler mean per feature
+    std::vector<double> m_featureScale; //!< StandardScaler scale per feature
+    double m_targetMin;                 //!< MinMaxScaler minimum of the target
+    double m_targetMax;                 //!< MinMaxScaler maximum of the target
+
+    std::vector<double> m_weightIh;  //!< Gate input weights (4H x I, gates i, f, g, o)
+    std::vector<double> m_weightHh;  //!< Gate recurrent weights (4H x H)
+    std::vector<double> m_bias;      //!< Gate biases, bias_ih + bias_hh (4H)
+    std::vector<double> m_fc1Weight; //!< fc_1 weights (H x H)
+    std::vector<double> m_fc1Bias;   //!< fc_1 bias (H)
+    std::vector<double> m_fc2Weight; //!< fc_2 weights (H x H)
+    std::vector<double> m_fc2Bias;   //!< fc_2 bias (H)
+    std::vector<double> m_fc3Weight; //!< fc_3 weights (H x H)
+    std::vector<double> m_fc3Bias;   //!< fc_3 bias (H)
+    std::vector<double> m_fcWeight;  //!< Output layer weights (H)
+    double m_fcBias;                 //!< Output layer bias
+};
+
+/**
+ * \ingroup randomnoise
+ * \brief Streaming inference with an LstmModel.
+ *
+ * Each client owns one predictor. trainLSTM.py trains on windows of
+ * seq_length samples starting from a zero state, so by default the predictor
+ * keeps the last SetWindow() samples and every Predict() replays them from a
+ * zero state, matching what the model was trained on. With a window of zero
+ * the hidden and cell state are instead kept between calls: every sample
+ * costs a single LSTM cell step and the state covers the whole history, which
+ * only suits models trained on unbounded sequences.
+ */
+class LstmPredictor
+{
+  public:
+    LstmPredictor();
+    ~LstmPredictor();
+
+    /**
+     * \brief Set the model and reset the state, dropping any trainer.
+     * \param model the model to run
+     */
+    void SetModel(Ptr<const LstmModel> model);
+
+    /**
+     * \return the model in use, or nullptr if none was set
+     */
+    Ptr<const LstmModel> GetModel() const;
+
+    /**
+     * \brief Set the number of samples a prediction looks at.
+     * \param window seq_length the model was trained with, 0 to keep the
+     * state over the whole history
+     */
+    void SetWindow(uint32_t window);
+
+    /**
+     * \return the number of samples a prediction looks at, 0 for all
+     */
+    uint32_t GetWindow() const;
+
+    /**
+     * \brief Zero the hidden and cell state and forget the window.
+     */
+    void Reset();
+
+    /**
+     * \brief Add one sample, advancing the LSTM if there is no window.
+     * \param features GetInputSize() unscaled feature values
+     */
+    void Step(const double* features);
+
+    /**
+     * \brief Run the LSTM over the window, then the dense head on its hidden
+     * state.
+     * \return the predicted available bandwidth ratio
+     */
+    double Predict();
+
+    /**
+     * \brief Use the output layer published by a trainer instead of the
+     * model's.
+     * \param trainer the trainer fine-tuning the model, nullptr to stop
+     */
+    void SetTrainer(Ptr<OnlineTrainer> trainer);
+
+    /**
+     * \return the input of the output layer at the last Predict()
+     */
+    const std::vector<double>& GetHeadInput() const;
+
+    /**
+     * \return the bytes of per-client state, without the shared model
+     */
+    uint32_t GetMemoryUsage() const;
+
+  private:
+    /**
+     * \brief Advance the hidden and cell state by one scaled input.
+     * \param x GetInputSize() scaled feature values
+     */
+    void CellStep(const double* x);
+
+    Ptr<const LstmModel> m_model;           //!< Shared weights
+    std::vector<double> m_h;                //!< Hidden state
+    std::vector<double> m_c;                //!< Cell state
+    std::vector<double> m_x;                //!< Scratch: scaled input
+    std::vector<double> m_gates;            //!< Scratch: gate pre-activations
+    std::vector<double> m_window;           //!< Ring of the last scaled inputs
+    uint32_t m_windowSize;                  //!< Samples in a full m_window
+    uint32_t m_windowCount;                 //!< Samples in m_window
+    uint32_t m_windowNext;                  //!< Slot of the next sample in m_window
+    std::vector<double> m_layerA;           //!< Scratch: dense head activations
+    std::vector<double> m_layerB;           //!< Scratch: dense head activations, output layer input
+    Ptr<OnlineTrainer> m_trainer;           //!< Source of fine-tuned output layers
+    std::shared_ptr<const LstmHead> m_head; //!< Latest output layer of m_trainer
+    uint64_t m_headVersion;                 //!< Version of m_head
+};
+
+} // namespace ns3
+
+#endif /* LSTM_PREDICTOR_H */
@@ -0,0 +1,149 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/mapped_file.h"
+
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <fcntl.h>
+#include <map>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("MappedFile");
+
+MappedFile::MappedFile()
+    : m_data(nullptr),
+      m_size(0)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+Ptr<const MappedFile>
+MappedFile::Share(const std::string& path)
+{
+    NS_LOG_FUNCTION(path);
+    static std::map<std::string, Ptr<const MappedFile>> files;
+
+    auto it = files.find(path);
+    if (it != files.end())
+    {
+        return it->second;
+    }
+    Ptr<MappedFile> file = Create<MappedFile>();
+    if (!file->Open(path))
+    {
+        return nullptr;
+    }
+    files[path] = file;
+    return file;
+}
+
+bool
+MappedFile::Open(const std::string& path)
+{
+    NS_LOG_FUNCTION(this << path);
+    Close();
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+    {
+        NS_LOG_WARN("Could not open " << path);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1)
+    {
+        close(fd);
+        return false;
+    }
+    if (st.st_size > 0)
+    {
+        void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            NS_LOG_WARN("Could not map " << path);
+            close(fd);
+            return false;
+        }
+        m_data = static_cast<uint8_t*>(data);
+        m_size = st.st_size;
+    }
+    // the mapping stays valid after the descriptor is closed
+    close(fd);
+    return true;
+}
+
+void
+MappedFile::Close()
+{
+    if (m_data)
+    {
+        munmap(m_data, m_size);
+    }
+    m_data = nullptr;
+    m_size = 0;
+}
+
+const uint8_t*
+MappedFile::GetData() const
+{
+    return m_data;
+}
+
+uint64_t
+MappedFile::GetSize() const
+{
+    return m_size;
+}
+
+void
+MappedFile::AdviseSequential() const
+{
+    if (m_data)
+    {
+        madvise(m_data, m_size, MADV_SEQUENTIAL);
+    }
+}
+
+void
+MappedFile::AdviseWillNeed() const
+{
+    if (m_data)
+    {
+        madvise(m_data, m_size, MADV_WILLNEED);
+    }
+}
+
+void
+MappedFile::Release(uint64_t offset) const
+{
+    uint64_t pageSize = sysconf(_SC_PAGESIZE);
+    uint64_t length = std::min(offset, m_size) / pageSize * pageSize;
+    if (m_data && length > 0)
+    {
+        madvise(m_data, length, MADV_DONTNEED);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,104 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+
+#include <stdint.h>
+#include <string>
+
+namespace ns3
+{
+
+/**
+ * \ingroup randomnoise
+ * \brief A read-only memory mapping of a whole file.
+ *
+ * Used to stream large trace files without reading them into memory. The
+ * mapping is shared by everyone holding a pointer to it.
+ */
+class MappedFile : public SimpleRefCount<MappedFile>
+{
+  public:
+    MappedFile();
+    ~MappedFile();
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * \brief Map a file once per process and share the mapping.
+     *
+     * Every caller asking for the same path gets the same mapping, so many
+     * readers of one file cost one set of page cache pages and no copies.
+     *
+     * \param path the file to map
+     * \return the shared mapping, or nullptr if the file could not be mapped
+     */
+    static Ptr<const MappedFile> Share(const std::string& path);
+
+    /**
+     * \brief Map a file, unmapping any previous one.
+     * \param path the file to map
+     * \return false if the file could not be opened or mapped
+     */
+    bool Open(const std::string& path);
+
+    /**
+     * \brief Unmap the file.
+     */
+    void Close();
+
+    /**
+     * \return the first byte of the file, or nullptr if nothing is mapped
+     */
+    const uint8_t* GetData() const;
+
+    /**
+     * \return the size of the file in bytes
+     */
+    uint64_t GetSize() const;
+
+    /**
+     * \brief Tell the kernel the file will be read front to back.
+     */
+    void AdviseSequential() const;
+
+    /**
+     * \brief Ask the kernel to start reading the whole file in.
+     */
+    void AdviseWillNeed() const;
+
+    /**
+     * \brief Drop the pages before an offset from the resident set.
+     *
+     * Lets a single pass over a file larger than memory run in constant RSS.
+     *
+     * \param offset bytes before this offset will not be read again
+     */
+    void Release(uint64_t offset) const;
+
+  private:
+    uint8_t* m_data; //!< Start of the mapping
+    uint64_t m_size; //!< Size of the mapping
+};
+
+} // namespace ns3
+
+#endif /* MAPPED_FILE_H */
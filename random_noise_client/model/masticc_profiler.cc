@@ -0,0 +1,107 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/masticc_profiler.h"
+
+#ifdef MASTICC_PROFILING
+
+#include "ns3/simulator.h"
+
+#include <iomanip>
+#include <iostream>
+
+namespace ns3
+{
+
+namespace
+{
+const char* const SECTION_NAMES[MasticcProfiler::SECTION_COUNT] = {
+    "send",
+    "handle read",
+    "  inference",
+    "trace",
+    "flow sample",
+};
+} // namespace
+
+uint32_t
+MasticcProfiler::AddClient(std::string name)
+{
+    ClientStats client;
+    client.name = std::move(name);
+    m_clients.push_back(client);
+    return m_clients.size() - 1;
+}
+
+void
+MasticcProfiler::Start()
+{
+    m_running = true;
+    m_start = std::chrono::steady_clock::now();
+    m_startEvents = Simulator::GetEventCount();
+    m_depth = 0;
+    m_sectionsNs = 0;
+    for (auto& section : m_sections)
+    {
+        section = SectionStats();
+    }
+    m_clients.clear();
+    Simulator::ScheduleDestroy(&MasticcProfiler::Report);
+}
+
+void
+MasticcProfiler::Report()
+{
+    MasticcProfiler& profiler = Get();
+    profiler.Print(std::clog);
+    profiler.m_running = false;
+}
+
+void
+MasticcProfiler::Print(std::ostream& os) const
+{
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+    double simulated = Simulator::Now().GetSeconds();
+    uint64_t events = Simulator::GetEventCount() - m_startEvents;
+
+    std::ios_base::fmtflags flags = os.flags();
+    os << std::fixed << std::setprecision(3);
+    os << "masticc profile: " << simulated << " simulated s in " << wall << " wall s ("
+       << simulated / wall << " simulated s per wall s)\n";
+    os << "  events executed " << events << " (" << std::setprecision(0) << events / wall
+       << " per wall s)\n";
+
+    os << std::setprecision(3);
+    os << "  " << std::left << std::setw(14) << "section" << std::right << std::setw(12) << "calls"
+       << std::setw(14) << "total ms" << std::setw(12) << "ns/call" << '\n';
+    for (uint32_t i = 0; i < SECTION_COUNT; i++)
+    {
+        const SectionStats& section = m_sections[i];
+        os << "  " << std::left << std::setw(14) << SECTION_NAMES[i] << std::right << std::setw(12)
+           << section.calls << std::setw(14) << section.ns / 1e6 << std::setw(12)
+           << (section.calls > 0 ? section.ns / section.calls : 0) << '\n';
+    }
+    os << "  " << std::left << std::setw(26) << "scheduler, stack, other" << std::right
+       << std::setw(14) << wall * 1e3 - m_sectionsNs / 1e6 << '\n';
+
+    for (const ClientStats& client : m_clients)
+    {
+        os << "  " << client.name << ": " << client.tx << " sent, " << client.rx << " received\n";
+    }
+    os.flags(flags);
+}
+
+} // namespace ns3
+
+#endif /* MASTICC_PROFILING */
@@ -0,0 +1,213 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MASTICC_PROFILER_H
+#define MASTICC_PROFILER_H
+
+/**
+ * \file
+ * \ingroup randomnoise
+ * Wall-clock profiling of masticc runs.
+ *
+ * Configure with -DMASTICC_PROFILING=ON to enable. Otherwise every
+ * MASTICC_PROFILE_* macro expands to nothing and no profiling code is built.
+ * The summary is printed to std::clog by Simulator::Destroy().
+ */
+
+#ifdef MASTICC_PROFILING
+
+#include <chrono>
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup randomnoise
+ * \brief Process-wide wall-clock timers and counters.
+ */
+class MasticcProfiler
+{
+  public:
+    /// Timed code sections
+    enum Section
+    {
+        SECTION_SEND,        //!< RandomNoiseClient::Send
+        SECTION_HANDLE_READ, //!< RandomNoiseClient::HandleRead
+        SECTION_INFERENCE,   //!< Bandwidth prediction, inside HandleRead
+        SECTION_TRACE,       //!< Header summary capture
+        SECTION_FLOW_SAMPLE, //!< FlowStatsSampler
+        SECTION_COUNT,
+    };
+
+    /**
+     * \return the profiler of the current simulation
+     */
+    static MasticcProfiler& Get()
+    {
+        static MasticcProfiler profiler;
+        if (!profiler.m_running)
+        {
+            profiler.Start();
+        }
+        return profiler;
+    }
+
+    /**
+     * \brief Enter a timed section.
+     */
+    void Enter()
+    {
+        m_depth++;
+    }
+
+    /**
+     * \brief Leave a timed section.
+     * \param section the section
+     * \param ns time spent in it
+     */
+    void Leave(Section section, uint64_t ns)
+    {
+        m_sections[section].calls++;
+        m_sections[section].ns += ns;
+        if (--m_depth == 0)
+        {
+            m_sectionsNs += ns;
+        }
+    }
+
+    /**
+     * \param name name of the client in the summary
+     * \return the slot to count the packets of the client in
+     */
+    uint32_t AddClient(std::string name);
+
+    /**
+     * \param client the slot returned by AddClient()
+     */
+    void CountTx(uint32_t client)
+    {
+        m_clients[client].tx++;
+    }
+
+    /**
+     * \param client the slot returned by AddClient()
+     */
+    void CountRx(uint32_t client)
+    {
+        m_clients[client].rx++;
+    }
+
+    /**
+     * \brief Print the summary of the current simulation.
+     * \param os the output stream
+     */
+    void Print(std::ostream& os) const;
+
+  private:
+    /// Time spent in one section
+    struct SectionStats
+    {
+        uint64_t calls{0}; //!< Times the section was entered
+        uint64_t ns{0};    //!< Total wall-clock time
+    };
+
+    /// Packets of one client
+    struct ClientStats
+    {
+        std::string name; //!< Name in the summary
+        uint64_t tx{0};   //!< Packets sent
+        uint64_t rx{0};   //!< Packets received
+    };
+
+    MasticcProfiler() = default;
+
+    /**
+     * \brief Reset the counters and report at the next Simulator::Destroy().
+     */
+    void Start();
+
+    /**
+     * \brief Print the summary to std::clog and stop.
+     */
+    static void Report();
+
+    bool m_running{false};                           //!< Counting for a simulation
+    std::chrono::steady_clock::time_point m_start;   //!< Wall clock at Start()
+    uint64_t m_startEvents{0};                       //!< Simulator event count at Start()
+    uint32_t m_depth{0};                             //!< Nesting of the open sections
+    uint64_t m_sectionsNs{0};                        //!< Time in outermost sections
+    SectionStats m_sections[SECTION_COUNT];          //!< Per-section times
+    std::vector<ClientStats> m_clients;              //!< Per-client packets
+};
+
+/**
+ * \ingroup randomnoise
+ * \brief Adds the lifetime of a scope to a profiler section.
+ */
+class MasticcScopedTimer
+{
+  public:
+    /**
+     * \param section the section the scope belongs to
+     */
+    explicit MasticcScopedTimer(MasticcProfiler::Section section)
+        : m_section(section),
+          m_start(std::chrono::steady_clock::now())
+    {
+        MasticcProfiler::Get().Enter();
+    }
+
+    ~MasticcScopedTimer()
+    {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now() - m_start)
+                      .count();
+        MasticcProfiler::Get().Leave(m_section, ns);
+    }
+
+    MasticcScopedTimer(const MasticcScopedTimer&) = delete;
+    MasticcScopedTimer& operator=(const MasticcScopedTimer&) = delete;
+
+  private:
+    MasticcProfiler::Section m_section;            //!< Section timed
+    std::chrono::steady_clock::time_point m_start; //!< Wall clock at construction
+};
+
+} // namespace ns3
+
+/// Time the rest of the enclosing scope as section SECTION_<name>
+#define MASTICC_PROFILE_SCOPE(name)                                                                \
+    ns3::MasticcScopedTimer masticcScopedTimer(ns3::MasticcProfiler::SECTION_##name)
+/// Register a client and store its slot in slot
+#define MASTICC_PROFILE_CLIENT(slot, name) slot = ns3::MasticcProfiler::Get().AddClient(name)
+/// Count a packet sent by the client in slot
+#define MASTICC_PROFILE_TX(slot) ns3::MasticcProfiler::Get().CountTx(slot)
+/// Count a packet received by the client in slot
+#define MASTICC_PROFILE_RX(slot) ns3::MasticcProfiler::Get().CountRx(slot)
+
+#else /* MASTICC_PROFILING */
+
+#define MASTICC_PROFILE_SCOPE(name)
+#define MASTICC_PROFILE_CLIENT(slot, name)
+#define MASTICC_PROFILE_TX(slot)
+#define MASTICC_PROFILE_RX(slot)
+
+#endif /* MASTICC_PROFILING */
+
+#endif /* MASTICC_PROFILER_H */
@@ -0,0 +1,160 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/noise_trace.h"
+
+#include "ns3/log.h"
+
+#include <string.h>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("NoiseTrace");
+
+static_assert(sizeof(NoiseTraceRecord) == 8, "NoiseTraceRecord must not be padded");
+static_assert(sizeof(NoiseTraceFileHeader) == 16, "NoiseTraceFileHeader must not be padded");
+
+namespace
+{
+const char NOISE_TRACE_MAGIC[8] = {'M', 'S', 'T', 'C', 'N', 'T', '0', '1'};
+} // namespace
+
+NoiseTraceWriter::NoiseTraceWriter(const std::string& filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+    memcpy(m_header.magic, NOISE_TRACE_MAGIC, sizeof(m_header.magic));
+    m_header.count = 0;
+    m_file.open(filename, std::ios::binary | std::ios::trunc);
+    if (!m_file.is_open())
+    {
+        NS_FATAL_ERROR("Could not create " << filename);
+    }
+    m_file.write(reinterpret_cast<const char*>(&m_header), sizeof(m_header));
+}
+
+NoiseTraceWriter::~NoiseTraceWriter()
+{
+    Close();
+}
+
+void
+NoiseTraceWriter::Write(uint32_t delta, uint32_t size)
+{
+    NoiseTraceRecord record;
+    record.delta = delta;
+    record.size = size;
+    m_file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    m_header.count++;
+}
+
+void
+NoiseTraceWriter::Close()
+{
+    if (m_file.is_open())
+    {
+        NS_LOG_FUNCTION(this);
+        m_file.seekp(0);
+        m_file.write(reinterpret_cast<const char*>(&m_header), sizeof(m_header));
+        m_file.close();
+    }
+}
+
+uint64_t
+NoiseTraceWriter::GetCount() const
+{
+    return m_header.count;
+}
+
+NoiseTraceReader::NoiseTraceReader()
+    : m_records(nullptr),
+      m_count(0),
+      m_next(0),
+      m_loop(true)
+{
+}
+
+bool
+NoiseTraceReader::Open(const std::string& path)
+{
+    NS_LOG_FUNCTION(this << path);
+    Ptr<const MappedFile> file = MappedFile::Share(path);
+    if (!file || file->GetSize() < sizeof(NoiseTraceFileHeader))
+    {
+        return false;
+    }
+    NoiseTraceFileHeader header;
+    memcpy(&header, file->GetData(), sizeof(header));
+    if (memcmp(header.magic, NOISE_TRACE_MAGIC, sizeof(header.magic)) != 0)
+    {
+        return false;
+    }
+    uint64_t stored = (file->GetSize() - sizeof(header)) / sizeof(NoiseTraceRecord);
+    if (stored < header.count)
+    {
+        NS_LOG_WARN(path << " is truncated, was the writer closed?");
+        header.count = stored;
+    }
+    if (header.count == 0)
+    {
+        return false;
+    }
+    // readers start at different offsets, so read the whole trace in early
+    file->AdviseWillNeed();
+    m_file = file;
+    m_records = reinterpret_cast<const NoiseTraceRecord*>(file->GetData() + sizeof(header));
+    m_count = header.count;
+    m_next = 0;
+    return true;
+}
+
+void
+NoiseTraceReader::SetLoop(bool loop)
+{
+    m_loop = loop;
+}
+
+void
+NoiseTraceReader::Seek(uint64_t index)
+{
+    NS_LOG_FUNCTION(this << index);
+    m_next = m_count > 0 ? index % m_count : 0;
+}
+
+bool
+NoiseTraceReader::Next(NoiseTraceRecord& record)
+{
+    if (m_next == m_count)
+    {
+        if (!m_loop || m_count == 0)
+        {
+            return false;
+        }
+        m_next = 0;
+    }
+    if (m_next + PREFETCH_DISTANCE < m_count)
+    {
+        __builtin_prefetch(m_records + m_next + PREFETCH_DISTANCE);
+    }
+    record = m_records[m_next++];
+    return true;
+}
+
+uint64_t
+NoiseTraceReader::GetCount() const
+{
+    return m_count;
+}
+
+} // namespace ns3
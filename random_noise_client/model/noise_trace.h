@@ -0,0 +1,139 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NOISE_TRACE_H
+#define NOISE_TRACE_H
+
+#include "ns3/mapped_file.h"
+#include "ns3/ptr.h"
+
+#include <fstream>
+#include <stdint.h>
+#include <string>
+
+namespace ns3
+{
+
+/**
+ * \ingroup randomnoise
+ * \brief File header of a noise trace.
+ *
+ * The header is followed by count NoiseTraceRecord entries.
+ */
+struct NoiseTraceFileHeader
+{
+    char magic[8];  //!< "MSTCNT01"
+    uint64_t count; //!< Number of records
+};
+
+/**
+ * \ingroup randomnoise
+ * \brief One packet of a noise trace.
+ */
+struct NoiseTraceRecord
+{
+    uint32_t delta; //!< Time since the previous packet (us)
+    uint32_t size;  //!< UDP payload (bytes)
+};
+
+/**
+ * \ingroup randomnoise
+ * \brief Writes a noise trace, as done by masticc-convert-trace.
+ */
+class NoiseTraceWriter
+{
+  public:
+    /**
+     * \param filename the file to create
+     */
+    NoiseTraceWriter(const std::string& filename);
+    ~NoiseTraceWriter();
+
+    /**
+     * \brief Append a packet.
+     * \param delta time since the previous packet (us)
+     * \param size UDP payload (bytes)
+     */
+    void Write(uint32_t delta, uint32_t size);
+
+    /**
+     * \brief Write the final record count and close the file.
+     */
+    void Close();
+
+    /**
+     * \return the number of records written
+     */
+    uint64_t GetCount() const;
+
+  private:
+    std::ofstream m_file;          //!< The trace
+    NoiseTraceFileHeader m_header; //!< Header, rewritten on Close
+};
+
+/**
+ * \ingroup randomnoise
+ * \brief Replays a noise trace from a shared memory mapping.
+ *
+ * The mapping comes from MappedFile::Share, so any number of readers of the
+ * same file share one read-only copy; a reader only holds its position.
+ */
+class NoiseTraceReader
+{
+  public:
+    NoiseTraceReader();
+
+    /**
+     * \param path the noise trace
+     * \return false if the file is missing, empty or not a noise trace
+     */
+    bool Open(const std::string& path);
+
+    /**
+     * \param loop restart from the first record after the last one
+     */
+    void SetLoop(bool loop);
+
+    /**
+     * \brief Move to a record.
+     * \param index the next record to read, taken modulo the trace length
+     */
+    void Seek(uint64_t index);
+
+    /**
+     * \param record filled in on success
+     * \return false at the end of a trace that does not loop
+     */
+    bool Next(NoiseTraceRecord& record);
+
+    /**
+     * \return the number of records in the trace
+     */
+    uint64_t GetCount() const;
+
+  private:
+    /// Records read ahead of the current one by the software prefetch
+    static const uint64_t PREFETCH_DISTANCE = 64;
+
+    Ptr<const MappedFile> m_file;      //!< Shared mapping
+    const NoiseTraceRecord* m_records; //!< First record in the mapping
+    uint64_t m_count;                  //!< Number of records
+    uint64_t m_next;                   //!< Next record to read
+    bool m_loop;                       //!< Restart after the last record
+};
+
+} // namespace ns3
+
+#endif /* NOISE_TRACE_H */
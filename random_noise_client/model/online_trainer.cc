@@ -0,0 +1,282 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/online_trainer.h"
+
+#include "ns3/abort.h"
+#include "ns3/boolean.h"
+#include "ns3/data-rate.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/packet.h"
+#include "ns3/point-to-point-net-device.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("OnlineTrainer");
+
+NS_OBJECT_ENSURE_REGISTERED(OnlineTrainer);
+
+TypeId
+OnlineTrainer::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::OnlineTrainer")
+            .SetParent<Object>()
+            .SetGroupName("Applications")
+            .AddConstructor<OnlineTrainer>()
+            .AddAttribute("LearningRate",
+                          "SGD step size on the squared error of the scaled target",
+                          DoubleValue(1e-3),
+                          MakeDoubleAccessor(&OnlineTrainer::m_learningRate),
+                          MakeDoubleChecker<double>(0))
+            .AddAttribute("BatchSize",
+                          "Predictions per SGD step",
+                          UintegerValue(32),
+                          MakeUintegerAccessor(&OnlineTrainer::m_batchSize),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("Synchronous",
+                          "Train on the simulation thread, for reproducible runs",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&OnlineTrainer::m_synchronous),
+                          MakeBooleanChecker());
+    return tid;
+}
+
+OnlineTrainer::OnlineTrainer()
+    : m_capacity(0),
+      m_bits(0),
+      m_stopping(false),
+      m_version(0),
+      m_bias(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+OnlineTrainer::~OnlineTrainer()
+{
+    NS_LOG_FUNCTION(this);
+    StopWorker();
+}
+
+void
+OnlineTrainer::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    StopWorker();
+    Object::DoDispose();
+}
+
+void
+OnlineTrainer::SetModel(Ptr<const LstmModel> model)
+{
+    NS_LOG_FUNCTION(this << model);
+    NS_ABORT_MSG_IF(m_worker.joinable(), "The model cannot change while training");
+    m_model = model;
+    m_weight = model->m_fcWeight;
+    m_bias = model->m_fcBias;
+    m_grad.assign(m_weight.size(), 0);
+    m_pending.clear();
+    auto head = std::make_shared<LstmHead>();
+    head->weight = m_weight;
+    head->bias = m_bias;
+    std::lock_guard<std::mutex> lock(m_headMutex);
+    m_head = head;
+    m_version++;
+}
+
+Ptr<const LstmModel>
+OnlineTrainer::GetModel() const
+{
+    return m_model;
+}
+
+void
+OnlineTrainer::SetBottleneck(Ptr<NetDevice> device)
+{
+    NS_LOG_FUNCTION(this << device);
+    Ptr<PointToPointNetDevice> p2p = DynamicCast<PointToPointNetDevice>(device);
+    NS_ABORT_MSG_UNLESS(p2p, "The bottleneck must be a point-to-point device");
+    DataRateValue rate;
+    p2p->GetAttribute("DataRate", rate);
+    m_capacity = rate.Get().GetBitRate();
+    p2p->TraceConnectWithoutContext("PhyTxBegin",
+                                    MakeCallback(&OnlineTrainer::BottleneckTx, this));
+}
+
+void
+OnlineTrainer::BottleneckTx(Ptr<const Packet> packet)
+{
+    m_bits += packet->GetSize() * 8;
+}
+
+OnlineTrainer::Mark
+OnlineTrainer::GetMark() const
+{
+    Mark mark;
+    mark.time = Simulator::Now();
+    mark.bits = m_bits;
+    return mark;
+}
+
+double
+OnlineTrainer::TakeFreeRatio(Mark& mark) const
+{
+    NS_ABORT_MSG_UNLESS(m_capacity > 0, "OnlineTrainer has no bottleneck");
+    double elapsed = (Simulator::Now() - mark.time).GetSeconds();
+    double ratio = 1;
+    if (elapsed > 0)
+    {
+        ratio = std::clamp(1 - (m_bits - mark.bits) / (m_capacity * elapsed), 0.0, 1.0);
+    }
+    mark = GetMark();
+    return ratio;
+}
+
+void
+OnlineTrainer::AddSample(const std::vector<double>& headInput, double label)
+{
+    NS_ASSERT_MSG(m_model && headInput.size() == m_weight.size(),
+                  "Sample does not match the model of the OnlineTrainer");
+    m_pending.insert(m_pending.end(), headInput.begin(), headInput.end());
+    m_pending.push_back(label);
+    if (m_pending.size() < m_batchSize * (m_weight.size() + 1))
+    {
+        return;
+    }
+
+    if (m_synchronous)
+    {
+        Train(m_pending);
+        m_pending.clear();
+        return;
+    }
+    if (!m_worker.joinable())
+    {
+        // started at the first mini-batch, so a trainer set up before a
+        // fork gets its thread in the process that trains
+        m_worker = std::thread(&OnlineTrainer::Work, this);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        if (m_queue.size() >= MAX_QUEUED_BATCHES)
+        {
+            NS_LOG_WARN("Online training is behind, dropping a mini-batch");
+            m_queue.pop_front();
+        }
+        m_queue.push_back(std::move(m_pending));
+    }
+    m_wake.notify_one();
+    m_pending.clear();
+}
+
+void
+OnlineTrainer::GetHead(std::shared_ptr<const LstmHead>& head, uint64_t& version) const
+{
+    uint64_t latest = m_version.load(std::memory_order_acquire);
+    if (latest != version)
+    {
+        std::lock_guard<std::mutex> lock(m_headMutex);
+        head = m_head;
+        version = latest;
+    }
+}
+
+uint64_t
+OnlineTrainer::GetSteps() const
+{
+    // the first version is the model's own output layer
+    uint64_t version = m_version.load(std::memory_order_relaxed);
+    return version > 0 ? version - 1 : 0;
+}
+
+void
+OnlineTrainer::Train(const std::vector<double>& batch)
+{
+    uint32_t hidden = m_weight.size();
+    uint32_t n = batch.size() / (hidden + 1);
+    double range = m_model->m_targetMax - m_model->m_targetMin;
+    std::fill(m_grad.begin(), m_grad.end(), 0);
+    double biasGrad = 0;
+    for (uint32_t s = 0; s < n; s++)
+    {
+        const double* input = &batch[s * (hidden + 1)];
+        double target = (input[hidden] - m_model->m_targetMin) / range;
+        double out = m_bias;
+        for (uint32_t j = 0; j < hidden; j++)
+        {
+            out += m_weight[j] * input[j];
+        }
+        double error = out - target;
+        for (uint32_t j = 0; j < hidden; j++)
+        {
+            m_grad[j] += error * input[j];
+        }
+        biasGrad += error;
+    }
+    for (uint32_t j = 0; j < hidden; j++)
+    {
+        m_weight[j] -= m_learningRate * m_grad[j] / n;
+    }
+    m_bias -= m_learningRate * biasGrad / n;
+
+    auto head = std::make_shared<LstmHead>();
+    head->weight = m_weight;
+    head->bias = m_bias;
+    {
+        std::lock_guard<std::mutex> lock(m_headMutex);
+        m_head = head;
+    }
+    m_version.fetch_add(1, std::memory_order_release);
+}
+
+void
+OnlineTrainer::Work()
+{
+    std::unique_lock<std::mutex> lock(m_queueMutex);
+    while (true)
+    {
+        m_wake.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+        if (m_queue.empty())
+        {
+            return;
+        }
+        std::vector<double> batch = std::move(m_queue.front());
+        m_queue.pop_front();
+        lock.unlock();
+        Train(batch);
+        lock.lock();
+    }
+}
+
+void
+OnlineTrainer::StopWorker()
+{
+    if (m_worker.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            m_stopping = true;
+        }
+        m_wake.notify_one();
+        m_worker.join();
+    }
+}
+
+} // namespace ns3
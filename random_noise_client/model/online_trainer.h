@@ -0,0 +1,188 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ONLINE_TRAINER_H
+#define ONLINE_TRAINER_H
+
+#include "ns3/lstm_predictor.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+namespace ns3
+{
+
+class NetDevice;
+class Packet;
+
+/**
+ * \ingroup randomnoise
+ * \brief Output layer weights of an LstmModel, as published by OnlineTrainer.
+ */
+struct LstmHead
+{
+    std::vector<double> weight; //!< Output layer weights (H)
+    double bias;                //!< Output layer bias
+};
+
+/**
+ * \ingroup randomnoise
+ * \brief Fine-tunes the output layer of an LstmModel while the simulation runs.
+ *
+ * Each prediction of a client using the trainer becomes a training sample:
+ * the input of the output layer, labelled with the true free fraction of the
+ * bottleneck since the client's previous prediction, the label of the
+ * training data. Mini-batches are SGD steps on the squared error of the
+ * output layer, run on a background thread. Every step publishes a new
+ * immutable LstmHead and bumps an atomic version; predictors compare the
+ * version at each prediction and only fetch the new weights when it changed.
+ *
+ * With the background thread, which weights a prediction sees depends on
+ * thread timing, so runs are not reproducible; Synchronous trains on the
+ * simulation thread instead. Threads do not survive fork(), so forked runs
+ * must use Synchronous.
+ */
+class OnlineTrainer : public Object
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    OnlineTrainer();
+    ~OnlineTrainer() override;
+
+    /// Start of a label interval, kept by each client
+    struct Mark
+    {
+        Time time;        //!< Start time
+        uint64_t bits{0}; //!< Bottleneck bits sent before the start
+    };
+
+    /**
+     * \brief Set the model to fine-tune and publish its output layer.
+     * \param model the model the clients run
+     */
+    void SetModel(Ptr<const LstmModel> model);
+
+    /**
+     * \return the fine-tuned model, or nullptr if none was set
+     */
+    Ptr<const LstmModel> GetModel() const;
+
+    /**
+     * \param device point-to-point device of R1 towards R2, the source of the labels
+     */
+    void SetBottleneck(Ptr<NetDevice> device);
+
+    /**
+     * \return a label interval starting now
+     */
+    Mark GetMark() const;
+
+    /**
+     * \brief Free fraction of the bottleneck since a mark.
+     * \param mark start of the interval, moved to the current time
+     * \return one minus the bits sent since the mark over the capacity, in [0, 1]
+     */
+    double TakeFreeRatio(Mark& mark) const;
+
+    /**
+     * \brief Queue a training sample.
+     * \param headInput input of the output layer, see LstmPredictor::GetHeadInput
+     * \param label true available bandwidth ratio
+     */
+    void AddSample(const std::vector<double>& headInput, double label);
+
+    /**
+     * \brief Refresh a copy of the published weights if it is outdated.
+     * \param head the caller's weights, replaced by the latest ones
+     * \param version version of head, updated with it
+     */
+    void GetHead(std::shared_ptr<const LstmHead>& head, uint64_t& version) const;
+
+    /**
+     * \return the number of SGD steps published so far
+     */
+    uint64_t GetSteps() const;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    /// Mini-batches waiting for the worker before the oldest are dropped
+    static const uint32_t MAX_QUEUED_BATCHES = 16;
+
+    /**
+     * \brief Count the bits starting transmission on the bottleneck.
+     * \param packet the packet
+     */
+    void BottleneckTx(Ptr<const Packet> packet);
+
+    /**
+     * \brief Run one SGD step and publish the new weights.
+     * \param batch samples of H inputs followed by the label
+     */
+    void Train(const std::vector<double>& batch);
+
+    /**
+     * \brief Body of the background thread.
+     */
+    void Work();
+
+    /**
+     * \brief Stop and join the background thread.
+     */
+    void StopWorker();
+
+    double m_learningRate; //!< SGD step size
+    uint32_t m_batchSize;  //!< Samples per SGD step
+    bool m_synchronous;    //!< Train on the simulation thread
+
+    Ptr<const LstmModel> m_model;  //!< Fine-tuned model
+    double m_capacity;             //!< Bottleneck capacity (bit/s)
+    uint64_t m_bits;               //!< Bits sent on the bottleneck
+    std::vector<double> m_pending; //!< Samples of the next mini-batch
+
+    // shared with the background thread
+    std::mutex m_queueMutex;                 //!< Protects m_queue and m_stopping
+    std::condition_variable m_wake;          //!< Signals the background thread
+    std::deque<std::vector<double>> m_queue; //!< Mini-batches to train on
+    bool m_stopping;                         //!< Ask the background thread to exit
+    std::thread m_worker;                    //!< Background thread
+    mutable std::mutex m_headMutex;          //!< Protects m_head
+    std::shared_ptr<const LstmHead> m_head;  //!< Latest published weights
+    std::atomic<uint64_t> m_version;         //!< Version of m_head
+
+    // trainer state, only touched by the thread that trains
+    std::vector<double> m_weight; //!< Output layer weights being trained
+    double m_bias;                //!< Output layer bias being trained
+    std::vector<double> m_grad;   //!< Scratch: weight gradient
+};
+
+} // namespace ns3
+
+#endif /* ONLINE_TRAINER_H */
@@ -15,9 +15,12 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
  #include <iostream>
+ #include <algorithm>
  #include<fstream>
- #include<map>
- #include<list>
+ #include<sstream>
+ #include<cmath>
+ #include <functional>
+ #include <unordered_map>
 
  #include<string.h>
 
@@ -29,19 +32,28 @@
 #include "ns3/random_noise_client.h"
 
 
+#include "ns3/abort.h"
+#include "ns3/boolean.h"
+#include "ns3/data-rate.h"
+#include "ns3/enum.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/inet6-socket-address.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/ipv4-header.h"
 #include "ns3/ipv6-address.h"
 #include "ns3/log.h"
+#include "ns3/masticc_profiler.h"
 #include "ns3/nstime.h"
+#include "ns3/pointer.h"
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 #include "ns3/socket-factory.h"
 #include "ns3/socket.h"
+#include "ns3/string.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/rng-stream.h"
 
 namespace ns3
 {
@@ -50,6 +62,122 @@ NS_LOG_COMPONENT_DEFINE("RandomNoiseClientApplication");
 
 NS_OBJECT_ENSURE_REGISTERED(RandomNoiseClient);
 
+namespace
+{
+
+/**
+ * \brief Describe a socket address for log messages.
+ * \param address an InetSocketAddress or Inet6SocketAddress
+ * \return "<ip> port <port>"
+ */
+std::string
+DescribeEndpoint(const Address& address)
+{
+    std::ostringstream description;
+    if (InetSocketAddress::IsMatchingType(address))
+    {
+        description << InetSocketAddress::ConvertFrom(address).GetIpv4() << " port "
+                    << InetSocketAddress::ConvertFrom(address).GetPort();
+    }
+    else if (Inet6SocketAddress::IsMatchingType(address))
+    {
+        description << Inet6SocketAddress::ConvertFrom(address).GetIpv6() << " port "
+                    << Inet6SocketAddress::ConvertFrom(address).GetPort();
+    }
+    return description.str();
+}
+
+/**
+ * \param s a string
+ * \return the bytes it holds outside of the string object
+ */
+uint32_t
+HeapSize(const std::string& s)
+{
+    const char* object = reinterpret_cast<const char*>(&s);
+    bool local = s.data() >= object && s.data() < object + sizeof(s);
+    return local ? 0 : s.capacity() + 1;
+}
+
+/**
+ * \brief Mix the hash of a value into a seed.
+ * \param seed the hash so far
+ * \param value the value to add
+ */
+template <typename T>
+void
+HashCombine(std::size_t& seed, const T& value)
+{
+    seed ^= std::hash<T>()(value) + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+}
+
+} // namespace
+
+template <typename V, typename T>
+class RandomNoiseClient::ConfigAccessor : public AttributeAccessor
+{
+  public:
+    /**
+     * \param field the accessed field
+     */
+    ConfigAccessor(T Config::*field)
+        : m_field(field)
+    {
+    }
+
+    bool Set(ObjectBase* object, const AttributeValue& value) const override
+    {
+        auto client = dynamic_cast<RandomNoiseClient*>(object);
+        auto typed = dynamic_cast<const V*>(&value);
+        if (!client || !typed)
+        {
+            return false;
+        }
+        T field = static_cast<T>(typed->Get());
+        // construction sets every attribute to its default, which leaves
+        // the shared default configuration untouched
+        if (!((*client->m_config).*m_field == field))
+        {
+            Ptr<Config> config = client->CopyConfig();
+            (*config).*m_field = field;
+            client->SetConfig(config);
+        }
+        return true;
+    }
+
+    bool Get(const ObjectBase* object, AttributeValue& value) const override
+    {
+        auto client = dynamic_cast<const RandomNoiseClient*>(object);
+        auto typed = dynamic_cast<V*>(&value);
+        if (!client || !typed)
+        {
+            return false;
+        }
+        typed->Set((*client->m_config).*m_field);
+        return true;
+    }
+
+    bool HasGetter() const override
+    {
+        return true;
+    }
+
+    bool HasSetter() const override
+    {
+        return true;
+    }
+
+  private:
+    T Config::*m_field; //!< The accessed field
+};
+
+template <typename V, typename T>
+Ptr<const AttributeAccessor>
+RandomNoiseClient::MakeConfigAccessor(T Config::*field)
+{
+    return Ptr<const AttributeAccessor>(new ConfigAccessor<V, T>(field), false);
+}
+
 TypeId
 RandomNoiseClient::GetTypeId()
 {
@@ -62,12 +190,12 @@ RandomNoiseClient::GetTypeId()
                 "MaxPackets",
                 "The maximum number of packets the application will send (zero means infinite)",
                 UintegerValue(0),
-                MakeUintegerAccessor(&RandomNoiseClient::m_count),
+                MakeConfigAccessor<UintegerValue>(&Config::count),
                 MakeUintegerChecker<uint32_t>())
             .AddAttribute("Interval",
                           "The time to wait between packets",
                           TimeValue(Seconds(1.0)),
-                          MakeTimeAccessor(&RandomNoiseClient::m_interval),
+                          MakeConfigAccessor<TimeValue>(&Config::interval),
                           MakeTimeChecker())
             .AddAttribute("RemoteAddress",
                           "The destination Address of the outbound packets",
@@ -83,7 +211,7 @@ RandomNoiseClient::GetTypeId()
                             "The Type of Service used to send IPv4 packets. "
                             "All 8 bits of the TOS byte are set (including ECN bits).",
                             UintegerValue(0),
-                            MakeUintegerAccessor(&RandomNoiseClient::m_tos),
+                            MakeConfigAccessor<UintegerValue>(&Config::tos),
                             MakeUintegerChecker<uint8_t>())
             .AddAttribute("PacketSize",
                             "Size of echo data in outbound packets",
@@ -93,18 +221,195 @@ RandomNoiseClient::GetTypeId()
             .AddAttribute("PacketSizeMean",
                             "Mean packet size for the normal distribution.",
                             DoubleValue(1000),  // Default mean value
-                            MakeDoubleAccessor(&RandomNoiseClient::m_packetSizeMean),
+                            MakeConfigAccessor<DoubleValue>(&Config::packetSizeMean),
                             MakeDoubleChecker<double>())
             .AddAttribute("PacketSizeVariance",
                             "Variance of packet size for the normal distribution.",
                             DoubleValue(200),  // Default variance
-                            MakeDoubleAccessor(&RandomNoiseClient::m_packetSizeVariance),
+                            MakeConfigAccessor<DoubleValue>(&Config::packetSizeVariance),
                             MakeDoubleChecker<double>())
             .AddAttribute("IntervalMean",
                             "Mean interval for the exponential distribution.",
                             DoubleValue(1.0),  // Default mean value
-                            MakeDoubleAccessor(&RandomNoiseClient::m_intervalMean),
+                            MakeConfigAccessor<DoubleValue>(&Config::intervalMean),
                             MakeDoubleChecker<double>())
+            .AddAttribute("TargetRate",
+                            "Average noise rate. When not zero the mean interval is derived "
+                            "from it, the mean packet size and BurstSize, and IntervalMean is "
+                            "only used to tell noise (not zero) from adaptive clients.",
+                            DataRateValue(DataRate(0)),
+                            MakeConfigAccessor<DataRateValue>(&Config::targetRate),
+                            MakeDataRateChecker())
+            .AddAttribute("SizeDistribution",
+                            "Distribution of the noise packet sizes. Normal and LogNormal take "
+                            "PacketSizeMean and PacketSizeVariance.",
+                            EnumValue(RandomNoiseClient::SIZE_NORMAL),
+                            MakeConfigAccessor<EnumValue<SizeDistribution>>(&Config::sizeDistribution),
+                            MakeEnumChecker(RandomNoiseClient::SIZE_NORMAL,
+                                            "Normal",
+                                            RandomNoiseClient::SIZE_LOGNORMAL,
+                                            "LogNormal",
+                                            RandomNoiseClient::SIZE_BIMODAL,
+                                            "Bimodal",
+                                            RandomNoiseClient::SIZE_EMPIRICAL,
+                                            "Empirical"))
+            .AddAttribute("BimodalSmallSize",
+                            "Small packet size of the Bimodal distribution.",
+                            UintegerValue(64),
+                            MakeConfigAccessor<UintegerValue>(&Config::bimodalSmallSize),
+                            MakeUintegerChecker<uint32_t>())
+            .AddAttribute("BimodalLargeSize",
+                            "Large packet size of the Bimodal distribution.",
+                            UintegerValue(1472),
+                            MakeConfigAccessor<UintegerValue>(&Config::bimodalLargeSize),
+                            MakeUintegerChecker<uint32_t>())
+            .AddAttribute("BimodalLargeProbability",
+                            "Probability of a large packet in the Bimodal distribution.",
+                            DoubleValue(0.5),
+                            MakeConfigAccessor<DoubleValue>(&Config::bimodalLargeProbability),
+                            MakeDoubleChecker<double>(0, 1))
+            .AddAttribute("EmpiricalSizes",
+                            "CDF of the Empirical distribution: comma separated "
+                            "size:cumulativeProbability pairs, ending with probability 1.",
+                            StringValue("64:0.5,576:0.6,1472:1"),
+                            MakeConfigAccessor<StringValue>(&Config::empiricalSizes),
+                            MakeStringChecker())
+            .AddAttribute("BurstSize",
+                            "Noise packets sent back to back in every send event. Not used "
+                            "when replaying a trace.",
+                            UintegerValue(1),
+                            MakeConfigAccessor<UintegerValue>(&Config::burstSize),
+                            MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("RateProfile",
+                            "Change of the TargetRate noise over time, from TargetRate to "
+                            "ProfileRate: a step at ProfilePeriod, a ramp lasting "
+                            "ProfilePeriod, or a sinusoid of period ProfilePeriod.",
+                            EnumValue(RandomNoiseClient::PROFILE_CONSTANT),
+                            MakeConfigAccessor<EnumValue<RateProfile>>(&Config::rateProfile),
+                            MakeEnumChecker(RandomNoiseClient::PROFILE_CONSTANT,
+                                            "Constant",
+                                            RandomNoiseClient::PROFILE_STEP,
+                                            "Step",
+                                            RandomNoiseClient::PROFILE_RAMP,
+                                            "Ramp",
+                                            RandomNoiseClient::PROFILE_SINUSOID,
+                                            "Sinusoid"))
+            .AddAttribute("ProfileRate",
+                            "Rate the RateProfile moves to from TargetRate.",
+                            DataRateValue(DataRate(0)),
+                            MakeConfigAccessor<DataRateValue>(&Config::profileRate),
+                            MakeDataRateChecker())
+            .AddAttribute("ProfilePeriod",
+                            "Time scale of the RateProfile, from the start of the application.",
+                            TimeValue(Seconds(10)),
+                            MakeConfigAccessor<TimeValue>(&Config::profilePeriod),
+                            MakeTimeChecker(Seconds(0), Time::Max(), true))
+            .AddAttribute("TraceFile",
+                            "Noise trace written by masticc-convert-trace. When set, packet "
+                            "sizes and intervals are replayed from it instead of drawn from the "
+                            "distributions; the adaptive client only takes the sizes.",
+                            StringValue(""),
+                            MakeConfigAccessor<StringValue>(&Config::traceFile),
+                            MakeStringChecker())
+            .AddAttribute("TraceLoop",
+                            "Restart the trace after its last packet instead of stopping.",
+                            BooleanValue(true),
+                            MakeConfigAccessor<BooleanValue>(&Config::traceLoop),
+                            MakeBooleanChecker())
+            .AddAttribute("TraceTimeScale",
+                            "Factor applied to the trace intervals, below 1 replays faster.",
+                            DoubleValue(1),
+                            MakeConfigAccessor<DoubleValue>(&Config::traceTimeScale),
+                            MakeDoubleChecker<double>(0))
+            .AddAttribute("TraceOffset",
+                            "First replayed trace packet, modulo the trace length, so that "
+                            "clients sharing a trace are not in lockstep.",
+                            UintegerValue(0),
+                            MakeUintegerAccessor(&RandomNoiseClient::m_traceOffset),
+                            MakeUintegerChecker<uint64_t>())
+            .AddAttribute("Predictor",
+                            "Implementation used by the adaptive client to predict the "
+                            "available bandwidth ratio.",
+                            EnumValue(RandomNoiseClient::PREDICTOR_NATIVE),
+                            MakeConfigAccessor<EnumValue<PredictorBackend>>(&Config::predictorBackend),
+                            MakeEnumChecker(RandomNoiseClient::PREDICTOR_NATIVE,
+                                            "Native",
+                                            RandomNoiseClient::PREDICTOR_PYTHON,
+                                            "Python"))
+            .AddAttribute("ModelFile",
+                            "LSTM model exported by exportLSTM.py, used by the Native predictor.",
+                            StringValue("masticc/savedModel.txt"),
+                            MakeStringAccessor(&RandomNoiseClient::SetModelFile,
+                                               &RandomNoiseClient::GetModelFile),
+                            MakeStringChecker())
+            .AddAttribute("ScalerFile",
+                            "scaler.txt of masticc-dataset-prep, replacing the feature scaler "
+                            "and target range of the ModelFile. Empty keeps the model's.",
+                            StringValue(""),
+                            MakeConfigAccessor<StringValue>(&Config::scalerFile),
+                            MakeStringChecker())
+            .AddAttribute("LstmWindow",
+                            "Latest samples the Native predictor runs the LSTM over from a zero "
+                            "state, the seq_length of trainLSTM.py. 0 keeps the state over the "
+                            "whole history.",
+                            UintegerValue(10),
+                            MakeConfigAccessor<UintegerValue>(&Config::lstmWindow),
+                            MakeUintegerChecker<uint32_t>())
+            .AddAttribute("PacingExponent",
+                            "Exponent of the adaptive pacing law: the next packet is sent "
+                            "after (1 - predicted ratio)^PacingExponent seconds.",
+                            DoubleValue(6),
+                            MakeConfigAccessor<DoubleValue>(&Config::pacingExponent),
+                            MakeDoubleChecker<double>(0))
+            .AddAttribute("OnlineTrainer",
+                            "Fine-tunes the output layer of the Native predictor with the true "
+                            "bottleneck state while the simulation runs; shared by the clients "
+                            "that use it.",
+                            PointerValue(),
+                            MakePointerAccessor(&RandomNoiseClient::m_trainer),
+                            MakePointerChecker<OnlineTrainer>())
+            .AddAttribute("Timestamps",
+                            "Start every packet with an EchoTimestampHeader, so that an "
+                            "EchoReflector returns the one-way delays. The header is part of "
+                            "the packet size.",
+                            BooleanValue(false),
+                            MakeConfigAccessor<BooleanValue>(&Config::timestamps),
+                            MakeBooleanChecker())
+            .AddAttribute("LatencySignal",
+                            "Delay fed to the predictor of the adaptive client: the round trip "
+                            "time, or the one-way forward delay returned by an EchoReflector "
+                            "(needs Timestamps).",
+                            EnumValue(RandomNoiseClient::SIGNAL_RTT),
+                            MakeConfigAccessor<EnumValue<LatencySignal>>(&Config::latencySignal),
+                            MakeEnumChecker(RandomNoiseClient::SIGNAL_RTT,
+                                            "Rtt",
+                                            RandomNoiseClient::SIGNAL_FORWARD,
+                                            "Forward"))
+            .AddAttribute("EcnFeedback",
+                            "Send ECN capable (ECT(0)) packets and use the CE marks an "
+                            "EchoReflector returns: their moving average is the 8th input of "
+                            "8-input models and cuts the predicted ratio by EcnBackoff. Needs "
+                            "Timestamps; without marks only the latency is used.",
+                            BooleanValue(false),
+                            MakeConfigAccessor<BooleanValue>(&Config::ecnFeedback),
+                            MakeBooleanChecker())
+            .AddAttribute("EcnGain",
+                            "Weight of every returned request in the moving average of the CE "
+                            "marks, the g of DCTCP.",
+                            DoubleValue(1.0 / 16),
+                            MakeConfigAccessor<DoubleValue>(&Config::ecnGain),
+                            MakeDoubleChecker<double>(0, 1))
+            .AddAttribute("EcnBackoff",
+                            "Fraction of the predicted available ratio given up when every "
+                            "request is CE marked; the cut is proportional to the marks.",
+                            DoubleValue(0.5),
+                            MakeConfigAccessor<DoubleValue>(&Config::ecnBackoff),
+                            MakeDoubleChecker<double>(0, 1))
+            .AddAttribute("PredictorScript",
+                            "Prediction script run by the Python predictor.",
+                            StringValue("masticc/useLSTM.py"),
+                            MakeConfigAccessor<StringValue>(&Config::predictorScript),
+                            MakeStringChecker())
             .AddTraceSource("Tx",
                             "A new packet is created and is sent",
                             MakeTraceSourceAccessor(&RandomNoiseClient::m_txTrace),
@@ -120,31 +425,149 @@ RandomNoiseClient::GetTypeId()
             .AddTraceSource("RxWithAddresses",
                             "A packet has been received",
                             MakeTraceSourceAccessor(&RandomNoiseClient::m_rxTraceWithAddresses),
-                            "ns3::Packet::TwoAddressTracedCallback");
+                            "ns3::Packet::TwoAddressTracedCallback")
+            .AddTraceSource("Prediction",
+                            "The adaptive client predicted the available bandwidth ratio",
+                            MakeTraceSourceAccessor(&RandomNoiseClient::m_predictionTrace),
+                            "ns3::RandomNoiseClient::PredictionTracedCallback")
+            .AddTraceSource("Delays",
+                            "A reply from an EchoReflector gave the one-way delays of a packet",
+                            MakeTraceSourceAccessor(&RandomNoiseClient::m_delaysTrace),
+                            "ns3::RandomNoiseClient::DelaysTracedCallback")
+            .AddTraceSource("Latency",
+                            "The adaptive client measured a latency sample",
+                            MakeTraceSourceAccessor(&RandomNoiseClient::m_latencyTrace),
+                            "ns3::RandomNoiseClient::LatencyTracedCallback");
     return tid;
 }
 
 RandomNoiseClient::RandomNoiseClient()
 {
     NS_LOG_FUNCTION(this);
-    m_sent = 0;
+    static Ptr<const Config> defaults = InternConfig(Create<Config>());
+    m_config = defaults;
     m_socket = nullptr;
-    m_sendEvent = EventId();
-    m_data = nullptr;
-    m_dataSize = 0;
-
-    m_normalRand = CreateObject<NormalRandomVariable>();
-    m_exponentialRand = CreateObject<ExponentialRandomVariable>();
+    m_peerPort = 0;
+    m_stream = -1;
+    m_traceOffset = 0;
+    m_sendFirst = 0;
+    m_ceFraction = 0;
+    m_profileClient = 0;
 }
 
 RandomNoiseClient::~RandomNoiseClient()
 {
     NS_LOG_FUNCTION(this);
     m_socket = nullptr;
+}
+
+bool
+RandomNoiseClient::Config::operator==(const Config& other) const
+{
+    return count == other.count && interval == other.interval && tos == other.tos &&
+           size == other.size && fill == other.fill && packetSizeMean == other.packetSizeMean &&
+           packetSizeVariance == other.packetSizeVariance && intervalMean == other.intervalMean &&
+           targetRate == other.targetRate && sizeDistribution == other.sizeDistribution &&
+           bimodalSmallSize == other.bimodalSmallSize &&
+           bimodalLargeSize == other.bimodalLargeSize &&
+           bimodalLargeProbability == other.bimodalLargeProbability &&
+           empiricalSizes == other.empiricalSizes && burstSize == other.burstSize &&
+           rateProfile == other.rateProfile && profileRate == other.profileRate &&
+           profilePeriod == other.profilePeriod && traceFile == other.traceFile &&
+           traceLoop == other.traceLoop && traceTimeScale == other.traceTimeScale &&
+           predictorBackend == other.predictorBackend && modelFile == other.modelFile &&
+           scalerFile == other.scalerFile && lstmWindow == other.lstmWindow &&
+           predictorScript == other.predictorScript && pacingExponent == other.pacingExponent &&
+           timestamps == other.timestamps && latencySignal == other.latencySignal &&
+           ecnFeedback == other.ecnFeedback && ecnGain == other.ecnGain &&
+           ecnBackoff == other.ecnBackoff;
+}
 
-    delete[] m_data;
-    m_data = nullptr;
-    m_dataSize = 0;
+uint32_t
+RandomNoiseClient::Config::GetSize() const
+{
+    return sizeof(Config) + fill.capacity() + HeapSize(empiricalSizes) + HeapSize(traceFile) +
+           HeapSize(modelFile) + HeapSize(scalerFile) + HeapSize(predictorScript);
+}
+
+std::size_t
+RandomNoiseClient::Config::Hash() const
+{
+    std::size_t seed = 0;
+    HashCombine(seed, count);
+    HashCombine(seed, interval.GetTimeStep());
+    HashCombine(seed, tos);
+    HashCombine(seed, size);
+    HashCombine(seed, std::string(fill.begin(), fill.end()));
+    HashCombine(seed, packetSizeMean);
+    HashCombine(seed, packetSizeVariance);
+    HashCombine(seed, intervalMean);
+    HashCombine(seed, targetRate.GetBitRate());
+    HashCombine(seed, static_cast<int>(sizeDistribution));
+    HashCombine(seed, bimodalSmallSize);
+    HashCombine(seed, bimodalLargeSize);
+    HashCombine(seed, bimodalLargeProbability);
+    HashCombine(seed, empiricalSizes);
+    HashCombine(seed, burstSize);
+    HashCombine(seed, static_cast<int>(rateProfile));
+    HashCombine(seed, profileRate.GetBitRate());
+    HashCombine(seed, profilePeriod.GetTimeStep());
+    HashCombine(seed, traceFile);
+    HashCombine(seed, traceLoop);
+    HashCombine(seed, traceTimeScale);
+    HashCombine(seed, static_cast<int>(predictorBackend));
+    HashCombine(seed, modelFile);
+    HashCombine(seed, scalerFile);
+    HashCombine(seed, lstmWindow);
+    HashCombine(seed, predictorScript);
+    HashCombine(seed, pacingExponent);
+    HashCombine(seed, timestamps);
+    HashCombine(seed, static_cast<int>(latencySignal));
+    HashCombine(seed, ecnFeedback);
+    HashCombine(seed, ecnGain);
+    HashCombine(seed, ecnBackoff);
+    return seed;
+}
+
+Ptr<const RandomNoiseClient::Config>
+RandomNoiseClient::InternConfig(Ptr<Config> config)
+{
+    // few distinct configurations are alive even with many clients: the
+    // ones in use and the intermediate ones of attributes being set
+    static std::unordered_multimap<std::size_t, Ptr<const Config>> live;
+    static std::size_t pruneAt = 16;
+    std::size_t hash = config->Hash();
+    auto range = live.equal_range(hash);
+    for (auto it = range.first; it != range.second; it++)
+    {
+        if (*it->second == *config)
+        {
+            return it->second;
+        }
+    }
+    if (live.size() >= pruneAt)
+    {
+        // forget the configurations no client uses anymore
+        for (auto it = live.begin(); it != live.end();)
+        {
+            it = it->second->GetReferenceCount() == 1 ? live.erase(it) : std::next(it);
+        }
+        pruneAt = std::max<std::size_t>(16, 2 * live.size());
+    }
+    live.emplace(hash, config);
+    return config;
+}
+
+Ptr<RandomNoiseClient::Config>
+RandomNoiseClient::CopyConfig() const
+{
+    return Create<Config>(*m_config);
+}
+
+void
+RandomNoiseClient::SetConfig(Ptr<Config> config)
+{
+    m_config = InternConfig(config);
 }
 
 void
@@ -162,6 +585,68 @@ RandomNoiseClient::SetRemote(Address addr)
     m_peerAddress = addr;
 }
 
+int64_t
+RandomNoiseClient::AssignStreams(int64_t stream)
+{
+    NS_LOG_FUNCTION(this << stream);
+    // the variables are only created at start, for the send mode
+    m_stream = stream;
+    if (m_normalRand)
+    {
+        m_normalRand->SetStream(stream);
+    }
+    if (m_exponentialRand)
+    {
+        m_exponentialRand->SetStream(stream + 1);
+    }
+    if (m_uniformRand)
+    {
+        m_uniformRand->SetStream(stream + 2);
+    }
+    if (m_sizeRand)
+    {
+        m_sizeRand->SetStream(stream + 3);
+    }
+    return 4;
+}
+
+uint32_t
+RandomNoiseClient::MemoryUsage::GetTotal() const
+{
+    return object + config + randomVariables + sendTimes + predictor;
+}
+
+RandomNoiseClient::MemoryUsage
+RandomNoiseClient::GetMemoryUsage() const
+{
+    MemoryUsage usage;
+    usage.object = sizeof(RandomNoiseClient) + HeapSize(m_peerDescription);
+    // the InternConfig registry holds one of the references
+    uint32_t users = std::max<uint32_t>(m_config->GetReferenceCount(), 2) - 1;
+    usage.config = m_config->GetSize() / users;
+    if (m_normalRand)
+    {
+        usage.randomVariables += sizeof(NormalRandomVariable) + sizeof(RngStream);
+    }
+    if (m_exponentialRand)
+    {
+        usage.randomVariables += sizeof(ExponentialRandomVariable) + sizeof(RngStream);
+    }
+    if (m_uniformRand)
+    {
+        usage.randomVariables += sizeof(UniformRandomVariable) + sizeof(RngStream);
+    }
+    if (m_sizeRand)
+    {
+        usage.randomVariables += std::max(sizeof(LogNormalRandomVariable),
+                                          sizeof(EmpiricalRandomVariable)) +
+                                 sizeof(RngStream);
+    }
+    usage.sendTimes = m_sendTimes.capacity() * sizeof(SendRecord);
+    usage.predictor = m_predictor.GetMemoryUsage();
+    return usage;
+}
+
 void
 RandomNoiseClient::DoDispose()
 {
@@ -173,60 +658,256 @@ void
 RandomNoiseClient::StartApplication()
 {
     NS_LOG_FUNCTION(this);
+    const Config& config = *m_config;
+
+    if (config.intervalMean == 0)
+    {
+        m_hot.mode = MODE_ADAPTIVE;
+    }
+    else if (!config.traceFile.empty())
+    {
+        m_hot.mode = MODE_TRACE;
+    }
+    else if (config.targetRate.GetBitRate() > 0)
+    {
+        m_hot.mode = MODE_RATE;
+    }
+    else
+    {
+        m_hot.mode = MODE_INTERVAL;
+    }
+    m_hot.replay = !config.traceFile.empty();
+    NS_ABORT_MSG_IF(config.latencySignal == SIGNAL_FORWARD && !config.timestamps,
+                    "LatencySignal Forward needs Timestamps");
+    NS_ABORT_MSG_IF(config.ecnFeedback && !config.timestamps, "EcnFeedback needs Timestamps");
+    ConfigureNoise();
+    MASTICC_PROFILE_CLIENT(m_profileClient, "client on node " + std::to_string(GetNode()->GetId()));
+
+    if (m_hot.mode == MODE_ADAPTIVE && config.predictorBackend == PREDICTOR_NATIVE)
+    {
+        LoadModel();
+    }
+
+    if (m_hot.replay)
+    {
+        if (!m_trace.Open(config.traceFile))
+        {
+            NS_FATAL_ERROR("Could not read noise trace " << config.traceFile);
+        }
+        m_trace.SetLoop(config.traceLoop);
+        m_trace.Seek(m_traceOffset);
+        m_trace.Next(m_traceNext);
+    }
 
-    m_normalRand->SetAttribute("Mean", DoubleValue(m_packetSizeMean));
-    m_normalRand->SetAttribute("Variance", DoubleValue(m_packetSizeVariance));
-    m_exponentialRand->SetAttribute("Mean", DoubleValue(m_intervalMean));
+    // the peer is resolved once here; Send and HandleRead only use the
+    // cached socket addresses
+    if (Ipv4Address::IsMatchingType(m_peerAddress))
+    {
+        m_peerSocketAddress =
+            InetSocketAddress(Ipv4Address::ConvertFrom(m_peerAddress), m_peerPort);
+    }
+    else if (Ipv6Address::IsMatchingType(m_peerAddress))
+    {
+        m_peerSocketAddress =
+            Inet6SocketAddress(Ipv6Address::ConvertFrom(m_peerAddress), m_peerPort);
+    }
+    else if (InetSocketAddress::IsMatchingType(m_peerAddress) ||
+             Inet6SocketAddress::IsMatchingType(m_peerAddress))
+    {
+        m_peerSocketAddress = m_peerAddress;
+    }
+    else
+    {
+        NS_ASSERT_MSG(false, "Incompatible address type: " << m_peerAddress);
+    }
+    bool ipv4 = InetSocketAddress::IsMatchingType(m_peerSocketAddress);
 
     if (!m_socket)
     {
         TypeId tid = TypeId::LookupByName("ns3::UdpSocketFactory");
         m_socket = Socket::CreateSocket(GetNode(), tid);
-        if (Ipv4Address::IsMatchingType(m_peerAddress))
+        if ((ipv4 ? m_socket->Bind() : m_socket->Bind6()) == -1)
         {
-            if (m_socket->Bind() == -1)
-            {
-                NS_FATAL_ERROR("Failed to bind socket");
-            }
-            m_socket->SetIpTos(m_tos); // Affects only IPv4 sockets.
-            m_socket->Connect(
-                InetSocketAddress(Ipv4Address::ConvertFrom(m_peerAddress), m_peerPort));
+            NS_FATAL_ERROR("Failed to bind socket");
         }
-        else if (Ipv6Address::IsMatchingType(m_peerAddress))
+        if (ipv4)
         {
-            if (m_socket->Bind6() == -1)
-            {
-                NS_FATAL_ERROR("Failed to bind socket");
-            }
-            m_socket->Connect(
-                Inet6SocketAddress(Ipv6Address::ConvertFrom(m_peerAddress), m_peerPort));
+            // Affects only IPv4 sockets.
+            m_socket->SetIpTos(config.ecnFeedback ? (config.tos & ~0x3) | Ipv4Header::ECN_ECT0
+                                                  : config.tos);
         }
-        else if (InetSocketAddress::IsMatchingType(m_peerAddress))
+        m_socket->Connect(m_peerSocketAddress);
+    }
+    m_socket->GetSockName(m_localAddress);
+    if (g_log.IsEnabled(LOG_INFO))
+    {
+        m_peerDescription = DescribeEndpoint(m_peerSocketAddress);
+    }
+
+    m_socket->SetRecvCallback(MakeCallback(&RandomNoiseClient::HandleRead, this));
+    m_socket->SetAllowBroadcast(true);
+    ScheduleTransmit(Seconds(0.0));
+}
+
+void
+RandomNoiseClient::ConfigureNoise()
+{
+    NS_LOG_FUNCTION(this);
+    const Config& config = *m_config;
+    m_profileStart = Simulator::Now();
+    NS_ABORT_MSG_IF(config.rateProfile == PROFILE_SINUSOID && config.profilePeriod.IsZero(),
+                    "A Sinusoid RateProfile needs a ProfilePeriod");
+    m_hot.thinning = m_hot.mode == MODE_RATE && config.rateProfile != PROFILE_CONSTANT;
+    m_hot.peakRate = GetPeakRate();
+    CreateRandomVariables();
+
+    if (m_hot.replay)
+    {
+        m_hot.meanPacketSize = 0;
+    }
+    else
+    {
+        switch (config.sizeDistribution)
         {
-            if (m_socket->Bind() == -1)
-            {
-                NS_FATAL_ERROR("Failed to bind socket");
-            }
-            m_socket->SetIpTos(m_tos); // Affects only IPv4 sockets.
-            m_socket->Connect(m_peerAddress);
+        case SIZE_LOGNORMAL: {
+            NS_ABORT_MSG_UNLESS(config.packetSizeMean > 0,
+                                "LogNormal sizes need a positive PacketSizeMean");
+            double sigma2 = std::log(1 + config.packetSizeVariance /
+                                             (config.packetSizeMean * config.packetSizeMean));
+            Ptr<LogNormalRandomVariable> logNormal = CreateObject<LogNormalRandomVariable>();
+            logNormal->SetAttribute("Mu",
+                                    DoubleValue(std::log(config.packetSizeMean) - sigma2 / 2));
+            logNormal->SetAttribute("Sigma", DoubleValue(std::sqrt(sigma2)));
+            m_sizeRand = logNormal;
+            m_hot.meanPacketSize = config.packetSizeMean;
+            break;
         }
-        else if (Inet6SocketAddress::IsMatchingType(m_peerAddress))
-        {
-            if (m_socket->Bind6() == -1)
+        case SIZE_BIMODAL:
+            m_hot.meanPacketSize = config.bimodalLargeProbability * config.bimodalLargeSize +
+                                   (1 - config.bimodalLargeProbability) * config.bimodalSmallSize;
+            break;
+        case SIZE_EMPIRICAL: {
+            Ptr<EmpiricalRandomVariable> empirical = CreateObject<EmpiricalRandomVariable>();
+            std::istringstream points(config.empiricalSizes);
+            std::string point;
+            double lastProbability = 0;
+            m_hot.meanPacketSize = 0;
+            while (std::getline(points, point, ','))
             {
-                NS_FATAL_ERROR("Failed to bind socket");
+                double size;
+                double probability;
+                char colon;
+                std::istringstream pair(point);
+                NS_ABORT_MSG_UNLESS((pair >> size >> colon >> probability) && colon == ':' &&
+                                        probability >= lastProbability && probability <= 1,
+                                    "Invalid EmpiricalSizes point " << point);
+                empirical->CDF(size, probability);
+                m_hot.meanPacketSize += size * (probability - lastProbability);
+                lastProbability = probability;
             }
-            m_socket->Connect(m_peerAddress);
+            NS_ABORT_MSG_UNLESS(lastProbability == 1,
+                                "EmpiricalSizes " << config.empiricalSizes
+                                                  << " must end at probability 1");
+            m_sizeRand = empirical;
+            break;
         }
-        else
-        {
-            NS_ASSERT_MSG(false, "Incompatible address type: " << m_peerAddress);
+        default:
+            m_hot.meanPacketSize = config.packetSizeMean;
+            break;
         }
     }
+    if (m_stream >= 0)
+    {
+        AssignStreams(m_stream);
+    }
+    if (m_hot.mode == MODE_RATE)
+    {
+        m_hot.rateInterval = config.burstSize * m_hot.meanPacketSize * 8 / m_hot.peakRate;
+    }
+}
 
-    m_socket->SetRecvCallback(MakeCallback(&RandomNoiseClient::HandleRead, this));
-    m_socket->SetAllowBroadcast(true);
-    ScheduleTransmit(Seconds(0.0));
+void
+RandomNoiseClient::CreateRandomVariables()
+{
+    NS_LOG_FUNCTION(this);
+    const Config& config = *m_config;
+    bool drawSizes = !m_hot.replay;
+    m_normalRand = nullptr;
+    m_exponentialRand = nullptr;
+    m_uniformRand = nullptr;
+    m_sizeRand = nullptr;
+    if (drawSizes && config.sizeDistribution == SIZE_NORMAL)
+    {
+        m_normalRand = CreateObject<NormalRandomVariable>();
+        m_normalRand->SetAttribute("Mean", DoubleValue(config.packetSizeMean));
+        m_normalRand->SetAttribute("Variance", DoubleValue(config.packetSizeVariance));
+    }
+    if (m_hot.mode == MODE_INTERVAL || m_hot.mode == MODE_RATE)
+    {
+        // with a TargetRate intervals are drawn with mean 1 and scaled by the
+        // mean interval at the peak rate
+        m_exponentialRand = CreateObject<ExponentialRandomVariable>();
+        m_exponentialRand->SetAttribute(
+            "Mean",
+            DoubleValue(m_hot.mode == MODE_RATE ? 1 : config.intervalMean));
+    }
+    if ((drawSizes && config.sizeDistribution == SIZE_BIMODAL) || m_hot.thinning)
+    {
+        m_uniformRand = CreateObject<UniformRandomVariable>();
+    }
+}
+
+uint32_t
+RandomNoiseClient::NextPacketSize()
+{
+    if (m_hot.replay)
+    {
+        return m_traceNext.size;
+    }
+    const Config& config = *m_config;
+    switch (config.sizeDistribution)
+    {
+    case SIZE_LOGNORMAL:
+    case SIZE_EMPIRICAL:
+        return static_cast<uint32_t>(m_sizeRand->GetValue());
+    case SIZE_BIMODAL:
+        return m_uniformRand->GetValue() < config.bimodalLargeProbability ? config.bimodalLargeSize
+                                                                          : config.bimodalSmallSize;
+    default:
+        return std::abs(static_cast<int>(m_normalRand->GetValue()));
+    }
+}
+
+double
+RandomNoiseClient::GetCurrentRate() const
+{
+    const Config& config = *m_config;
+    double from = config.targetRate.GetBitRate();
+    double to = config.profileRate.GetBitRate();
+    double t = (Simulator::Now() - m_profileStart).GetSeconds();
+    double period = config.profilePeriod.GetSeconds();
+    switch (config.rateProfile)
+    {
+    case PROFILE_STEP:
+        return t < period ? from : to;
+    case PROFILE_RAMP:
+        return t >= period ? to : from + (to - from) * t / period;
+    case PROFILE_SINUSOID:
+        return from + (to - from) * (1 - std::cos(2 * M_PI * t / period)) / 2;
+    default:
+        return from;
+    }
+}
+
+double
+RandomNoiseClient::GetPeakRate() const
+{
+    const Config& config = *m_config;
+    if (config.rateProfile == PROFILE_CONSTANT)
+    {
+        return config.targetRate.GetBitRate();
+    }
+    return std::max(config.targetRate.GetBitRate(), config.profileRate.GetBitRate());
 }
 
 void
@@ -241,7 +922,53 @@ RandomNoiseClient::StopApplication()
         m_socket = nullptr;
     }
 
-    Simulator::Cancel(m_sendEvent);
+    Simulator::Cancel(m_hot.sendEvent);
+}
+
+void
+RandomNoiseClient::SetModelFile(std::string modelFile)
+{
+    NS_LOG_FUNCTION(this << modelFile);
+    if (m_config->modelFile != modelFile)
+    {
+        Ptr<Config> config = CopyConfig();
+        config->modelFile = modelFile;
+        SetConfig(config);
+    }
+    if (m_predictor.GetModel())
+    {
+        // switching models while running, e.g. in a variant forked after warm-up
+        LoadModel();
+    }
+}
+
+std::string
+RandomNoiseClient::GetModelFile() const
+{
+    return m_config->modelFile;
+}
+
+void
+RandomNoiseClient::LoadModel()
+{
+    NS_LOG_FUNCTION(this);
+    const std::string& modelFile = m_config->modelFile;
+    Ptr<const LstmModel> model = LstmModel::Load(modelFile, m_config->scalerFile);
+    NS_ABORT_MSG_UNLESS(model->GetInputSize() == 7 ||
+                            (model->GetInputSize() == 8 && m_config->ecnFeedback),
+                        "Model " << modelFile << " does not take the 7 latency features"
+                                 << (m_config->ecnFeedback ? " (and the CE fraction)" : ""));
+    m_predictor.SetModel(model);
+    m_predictor.SetWindow(m_config->lstmWindow);
+    if (m_trainer)
+    {
+        if (!m_trainer->GetModel())
+        {
+            m_trainer->SetModel(model);
+        }
+        m_predictor.SetTrainer(m_trainer);
+        m_labelMark = m_trainer->GetMark();
+    }
 }
 
 void
@@ -254,17 +981,21 @@ RandomNoiseClient::SetDataSize(uint32_t dataSize)
     // that she doesn't care about the contents of the packet at all, so
     // neither will we.
     //
-    delete[] m_data;
-    m_data = nullptr;
-    m_dataSize = 0;
-    m_size = dataSize;
+    if (m_config->size == dataSize && m_config->fill.empty())
+    {
+        return;
+    }
+    Ptr<Config> config = CopyConfig();
+    config->fill.clear();
+    config->size = dataSize;
+    SetConfig(config);
 }
 
 uint32_t
 RandomNoiseClient::GetDataSize() const
 {
     NS_LOG_FUNCTION(this);
-    return m_size;
+    return m_config->size;
 }
 
 void
@@ -272,324 +1003,360 @@ RandomNoiseClient::SetFill(std::string fill)
 {
     NS_LOG_FUNCTION(this << fill);
 
-    uint32_t dataSize = fill.size() + 1;
-
-    if (dataSize != m_dataSize)
-    {
-        delete[] m_data;
-        m_data = new uint8_t[dataSize];
-        m_dataSize = dataSize;
-    }
-
-    memcpy(m_data, fill.c_str(), dataSize);
+    Ptr<Config> config = CopyConfig();
+    config->fill.assign(fill.c_str(), fill.c_str() + fill.size() + 1);
 
     //
     // Overwrite packet size attribute.
     //
-    m_size = dataSize;
+    config->size = config->fill.size();
+    SetConfig(config);
 }
 
 void
 RandomNoiseClient::SetFill(uint8_t fill, uint32_t dataSize)
 {
     NS_LOG_FUNCTION(this << fill << dataSize);
-    if (dataSize != m_dataSize)
-    {
-        delete[] m_data;
-        m_data = new uint8_t[dataSize];
-        m_dataSize = dataSize;
-    }
-
-    memset(m_data, fill, dataSize);
+    Ptr<Config> config = CopyConfig();
+    config->fill.assign(dataSize, fill);
 
     //
     // Overwrite packet size attribute.
     //
-    m_size = dataSize;
+    config->size = dataSize;
+    SetConfig(config);
 }
 
 void
 RandomNoiseClient::SetFill(uint8_t* fill, uint32_t fillSize, uint32_t dataSize)
 {
     NS_LOG_FUNCTION(this << fill << fillSize << dataSize);
-    if (dataSize != m_dataSize)
-    {
-        delete[] m_data;
-        m_data = new uint8_t[dataSize];
-        m_dataSize = dataSize;
-    }
-
-    if (fillSize >= dataSize)
-    {
-        memcpy(m_data, fill, dataSize);
-        m_size = dataSize;
-        return;
-    }
+    Ptr<Config> config = CopyConfig();
+    config->fill.resize(dataSize);
 
     //
-    // Do all but the final fill.
+    // Repeat the pattern, the last fill may be partial
     //
-    uint32_t filled = 0;
-    while (filled + fillSize < dataSize)
+    for (uint32_t filled = 0; filled < dataSize; filled += fillSize)
     {
-        memcpy(&m_data[filled], fill, fillSize);
-        filled += fillSize;
+        memcpy(&config->fill[filled], fill, std::min(fillSize, dataSize - filled));
     }
 
-    //
-    // Last fill may be partial
-    //
-    memcpy(&m_data[filled], fill, dataSize - filled);
-
     //
     // Overwrite packet size attribute.
     //
-    m_size = dataSize;
+    config->size = dataSize;
+    SetConfig(config);
 }
 
 void
 RandomNoiseClient::ScheduleTransmit(Time dt)
 {
     NS_LOG_FUNCTION(this << dt);
-    m_sendEvent = Simulator::Schedule(dt, &RandomNoiseClient::Send, this);
+    m_hot.sendEvent = Simulator::Schedule(dt, &RandomNoiseClient::Send, this);
 }
 
 void
 RandomNoiseClient::Send()
 {
     NS_LOG_FUNCTION(this);
+    MASTICC_PROFILE_SCOPE(SEND);
 
-    NS_ASSERT(m_sendEvent.IsExpired());
-
-    uint32_t packetSize = std::abs(static_cast<int>(m_normalRand->GetValue()));
-    std::cout << packetSize << "bytes"<< std::endl;
-    Ptr<Packet> p = Create<Packet>(packetSize);
-
+    NS_ASSERT(m_hot.sendEvent.IsExpired());
 
-    Address localAddress;
-    m_socket->GetSockName(localAddress);
-    // call to the trace sinks before the packet is actually sent,
-    // so that tags added to the packet can be sent as well
-    m_txTrace(p);
-    if (Ipv4Address::IsMatchingType(m_peerAddress))
+    const Config& config = *m_config;
+    bool noise = m_hot.mode == MODE_INTERVAL || m_hot.mode == MODE_RATE;
+    uint32_t burst = noise ? config.burstSize : 1;
+    if (m_hot.thinning && m_uniformRand->GetValue() * m_hot.peakRate >= GetCurrentRate())
     {
-        m_txTraceWithAddresses(
-            p,
-            localAddress,
-            InetSocketAddress(Ipv4Address::ConvertFrom(m_peerAddress), m_peerPort));
+        // the rate profile is followed by thinning: send events come at the
+        // peak rate and are kept with probability rate(now) / peak
+        burst = 0;
     }
-    else if (Ipv6Address::IsMatchingType(m_peerAddress))
+
+    bool more = true;
+    for (uint32_t i = 0; i < burst && more; i++)
     {
-        m_txTraceWithAddresses(
-            p,
-            localAddress,
-            Inet6SocketAddress(Ipv6Address::ConvertFrom(m_peerAddress), m_peerPort));
+        SendPacket(NextPacketSize());
+        more = (!m_hot.replay || m_trace.Next(m_traceNext)) &&
+               (m_hot.sent < config.count || config.count == 0);
     }
-    m_socket->Send(p);
-    double send_time = Now().GetSeconds();
-    messageTimings[p->GetUid()] = send_time;
-    std::cout << "send msg " << p->GetUid() << " at " << send_time << std::endl;
 
-    ++m_sent;
-
-    if (Ipv4Address::IsMatchingType(m_peerAddress))
+    if (!more)
     {
-        NS_LOG_INFO("At time " << Simulator::Now().As(Time::S) << " client sent " << m_size
-                               << " bytes to " << Ipv4Address::ConvertFrom(m_peerAddress)
-                               << " port " << m_peerPort);
+        return;
     }
-    else if (Ipv6Address::IsMatchingType(m_peerAddress))
+    switch (m_hot.mode)
     {
-        NS_LOG_INFO("At time " << Simulator::Now().As(Time::S) << " client sent " << m_size
-                               << " bytes to " << Ipv6Address::ConvertFrom(m_peerAddress)
-                               << " port " << m_peerPort);
+    case MODE_RATE:
+        ScheduleTransmit(Seconds(m_exponentialRand->GetValue() * m_hot.rateInterval));
+        break;
+    case MODE_TRACE:
+        ScheduleTransmit(Seconds(m_traceNext.delta * 1e-6 * config.traceTimeScale));
+        break;
+    case MODE_INTERVAL: {
+        float randInterval = m_exponentialRand->GetValue();
+        ScheduleTransmit(Seconds(randInterval));
+        break;
+    }
+    default: {
+        double predicted_bandwith_ratio = std::clamp(m_hot.predictedRatio, 0.0, 1.0);
+        m_hot.predictedRatio = predicted_bandwith_ratio;
+        double inverted_ratio = 1 - predicted_bandwith_ratio;
+        double delay_untill_next_package_send = std::pow(inverted_ratio, config.pacingExponent);
+        ScheduleTransmit(Seconds(delay_untill_next_package_send));
+        NS_LOG_INFO("Current bandwidth ratio " << predicted_bandwith_ratio << ", next send in "
+                                               << delay_untill_next_package_send << " s");
+        break;
+    }
     }
-    else if (InetSocketAddress::IsMatchingType(m_peerAddress))
+}
+
+void
+RandomNoiseClient::SendPacket(uint32_t packetSize)
+{
+    const Config& config = *m_config;
+    Ptr<Packet> p;
+    if (config.timestamps)
     {
-        NS_LOG_INFO(
-            "At time " << Simulator::Now().As(Time::S) << " client sent " << m_size << " bytes to "
-                       << InetSocketAddress::ConvertFrom(m_peerAddress).GetIpv4() << " port "
-                       << InetSocketAddress::ConvertFrom(m_peerAddress).GetPort());
+        EchoTimestampHeader header;
+        header.AddStamp({m_hot.sent, Simulator::Now().GetNanoSeconds(), 0});
+        uint32_t headerSize = header.GetSerializedSize();
+        p = Create<Packet>(packetSize > headerSize ? packetSize - headerSize : 0);
+        p->AddHeader(header);
     }
-    else if (Inet6SocketAddress::IsMatchingType(m_peerAddress))
+    else
     {
-        NS_LOG_INFO(
-            "At time " << Simulator::Now().As(Time::S) << " client sent " << m_size << " bytes to "
-                       << Inet6SocketAddress::ConvertFrom(m_peerAddress).GetIpv6() << " port "
-                       << Inet6SocketAddress::ConvertFrom(m_peerAddress).GetPort());
+        p = Create<Packet>(packetSize);
     }
 
-    if (m_intervalMean == 0){
-        act_as_noise_client = false;
-    }
-    if (m_sent < m_count || m_count == 0)
+    // call to the trace sinks before the packet is actually sent,
+    // so that tags added to the packet can be sent as well
+    m_txTrace(p);
+    m_txTraceWithAddresses(p, m_localAddress, m_peerSocketAddress);
+    m_socket->Send(p);
+    double send_time = Now().GetSeconds();
+    if (m_hot.mode == MODE_ADAPTIVE && !config.timestamps)
     {
-      if (act_as_noise_client == true){
-        float randInterval =  m_exponentialRand->GetValue();
-        Time nextInterval(Seconds(randInterval));
-        ScheduleTransmit(nextInterval);
-      }else{
-        //double delay_untill_next_package_send = optimal_speed * predicted_bandwith_ratio + slowest_speed * (1-predicted_bandwith_ratio);
-        if (predicted_bandwith_ratio < 0){predicted_bandwith_ratio = 0;}
-        if (predicted_bandwith_ratio > 1){predicted_bandwith_ratio = 1;}
-        double inverted_ratio = 1 - predicted_bandwith_ratio;
-        double delay_untill_next_package_send = inverted_ratio * inverted_ratio * inverted_ratio * inverted_ratio * inverted_ratio * inverted_ratio;
-        Time nextInterval(Seconds(delay_untill_next_package_send));
-        ScheduleTransmit(nextInterval);
-        std::cout << " * Current bandwith ratio: " << predicted_bandwith_ratio << std::endl;
-        std::cout << " * Delay untill next send: " << delay_untill_next_package_send << " s" << std::endl;
-      }
+        // only the adaptive client matches echoes to send times, stamped
+        // packets carry theirs
+        RecordSendTime(p->GetUid(), send_time);
+    }
 
+    ++m_hot.sent;
+    MASTICC_PROFILE_TX(m_profileClient);
 
+    NS_LOG_INFO("At time " << Simulator::Now().As(Time::S) << " client sent " << packetSize
+                           << " bytes to " << m_peerDescription << " (packet " << p->GetUid()
+                           << ")");
+}
 
+void
+RandomNoiseClient::RecordSendTime(uint64_t uid, double time)
+{
+    if (m_sendFirst == m_sendTimes.size())
+    {
+        // everything was answered, start over at the front
+        m_sendTimes.clear();
+        m_sendFirst = 0;
     }
+    else if (m_sendFirst >= 64 && 2 * m_sendFirst >= m_sendTimes.size())
+    {
+        m_sendTimes.erase(m_sendTimes.begin(), m_sendTimes.begin() + m_sendFirst);
+        m_sendFirst = 0;
+    }
+    m_sendTimes.push_back({uid, time});
+}
+
+bool
+RandomNoiseClient::TakeSendTime(uint64_t uid, double& time)
+{
+    for (uint32_t i = m_sendFirst; i < m_sendTimes.size(); i++)
+    {
+        if (m_sendTimes[i].uid == uid)
+        {
+            time = m_sendTimes[i].time;
+            m_sendFirst = i + 1;
+            return true;
+        }
+    }
+    return false;
 }
 
 void
 RandomNoiseClient::HandleRead(Ptr<Socket> socket)
 {
     NS_LOG_FUNCTION(this << socket);
+    MASTICC_PROFILE_SCOPE(HANDLE_READ);
+    // scratch shared by all clients, HandleRead does not nest
+    static std::vector<double> delays;
     Ptr<Packet> packet;
     Address from;
-    Address localAddress;
+    double receiveTime = Now().GetSeconds();
     while ((packet = socket->RecvFrom(from)))
     {
-        if (InetSocketAddress::IsMatchingType(from))
+        NS_LOG_INFO("At time " << Simulator::Now().As(Time::S) << " client received "
+                               << packet->GetSize() << " bytes from " << DescribeEndpoint(from));
+        m_rxTrace(packet);
+        m_rxTraceWithAddresses(packet, from, m_localAddress);
+        MASTICC_PROFILE_RX(m_profileClient);
+
+        double sendTime;
+        if (m_config->timestamps && EchoTimestampHeader::IsStamped(packet))
         {
-            NS_LOG_INFO("At time " << Simulator::Now().As(Time::S) << " client received "
-                                   << packet->GetSize() << " bytes from "
-                                   << InetSocketAddress::ConvertFrom(from).GetIpv4() << " port "
-                                   << InetSocketAddress::ConvertFrom(from).GetPort());
+            HandleStampedReply(packet, delays);
         }
-        else if (Inet6SocketAddress::IsMatchingType(from))
+        else if (m_hot.mode == MODE_ADAPTIVE && TakeSendTime(packet->GetUid(), sendTime))
         {
-            NS_LOG_INFO("At time " << Simulator::Now().As(Time::S) << " client received "
-                                   << packet->GetSize() << " bytes from "
-                                   << Inet6SocketAddress::ConvertFrom(from).GetIpv6() << " port "
-                                   << Inet6SocketAddress::ConvertFrom(from).GetPort());
+            delays.push_back(receiveTime - sendTime);
         }
-        socket->GetSockName(localAddress);
-        m_rxTrace(packet);
-        m_rxTraceWithAddresses(packet, from, localAddress);
-
-
-        if (act_as_noise_client == false){
-          // Calculate statistics
-          uint32_t uid_received = packet->GetUid();
-          double send_time = messageTimings[uid_received];
-          double receive_time = Now().GetSeconds();
-          double delay = receive_time - send_time;
-          messageTimings.erase(uid_received);
-
-          latencies.push_back(delay);
-          if (latencies.size() > view_size){
-            latencies.pop_front();
-          }
-
-
-
-          double mean = 0;
-          for (std::list<double>::iterator it=latencies.begin(); it != latencies.end(); ++it){
-            mean += *it;
-          }
-          mean = mean / latencies.size();
-
-          mean_latencies.push_back(mean);
-          if (mean_latencies.size() > view_size){
-            mean_latencies.pop_front();
-          }
-
-          double standard_deviation = 0;
-          for (std::list<double>::iterator it=latencies.begin(); it != latencies.end(); ++it){
-            standard_deviation += (*it - mean) * (*it - mean);
-          }
-          standard_deviation = sqrt(standard_deviation/latencies.size());
-
-          stdev_latency.push_back(standard_deviation);
-          //std::cout << standard_deviation << :: std::endl;
-          if (stdev_latency.size() > view_size){
-            stdev_latency.pop_front();
-          }
-
-          current_mean_latency = mean;
-          current_stdev_latency = standard_deviation;
-          current_latency = delay;
-          current_latency_smoothed = mean;
-          current_first_order_deriv = 0;
-          current_second_order_deriv = 0;
-          current_packet_loss = 0;
-
-          //std::cout << "received msg " << uid_received << std::endl;
-          //std::cout << "  * mean_latency: " << current_mean_latency << "\n  * stdev_latency: " << current_stdev_latency << "\n  * latency: " << current_latency << std::endl;
-
-          uint32_t testint = 13;
-          char command[1000];
-          std::string a = std::to_string(testint);
-          strcpy(command, "import os;os.system(\'python3 /home/luca/ns-3-dev/masticc/useLSTM.py " );
-
-          if (mean_latencies.size() == view_size){
-            strcat(command, std::to_string(view_size).c_str());
-            strcat(command, " ");
-            for(int i = 0; i < view_size; i++){
-                int counter = 0;
-                for (std::list<double>::iterator it=mean_latencies.begin(); it != mean_latencies.end(); ++it){
-                  if (counter == i){
-                    double value = *it;
-                    strcat(command, std::to_string(value).c_str());
-                    break;
-                  }
-                  counter+=1;
-                }
-                strcat(command, " ");
-                counter = 0;
-                for (std::list<double>::iterator it=stdev_latency.begin(); it != stdev_latency.end(); ++it){
-                  if (counter == i){
-                    double value = *it;
-                    strcat(command, std::to_string(value).c_str());
-                    break;
-                  }
-                  counter+=1;
-                }
-                strcat(command, " ");
-                for (std::list<double>::iterator it=latencies.begin(); it != latencies.end(); ++it){
-                  if (counter == i){
-                    double value = *it;
-                    strcat(command, std::to_string(value).c_str());
-                    break;
-                  }
-                  counter+=1;
-                }
-                for (int j = 0; j < 4; j++){
-                  strcat(command, " 0");
-                }
-                strcat(command, " ");
-            }
-          }
+    }
 
+    if (!delays.empty())
+    {
+        // echoes returned in a burst are handled together: one pass over the
+        // windows, one prediction with the latest state
+        AddLatencySamples(delays.data(), delays.size());
+        delays.clear();
+    }
+}
 
+void
+RandomNoiseClient::HandleStampedReply(Ptr<Packet> packet, std::vector<double>& delays)
+{
+    EchoTimestampHeader header;
+    packet->RemoveHeader(header);
+    int64_t now = Simulator::Now().GetNanoSeconds();
+    Time reflectorTx = header.GetReflectorTx();
+    bool forward = m_config->latencySignal == SIGNAL_FORWARD;
+    for (const EchoTimestampHeader::Stamp& stamp : header.GetStamps())
+    {
+        if (m_config->ecnFeedback)
+        {
+            double ce = stamp.ecn == Ipv4Header::ECN_CE ? 1 : 0;
+            m_ceFraction += m_config->ecnGain * (ce - m_ceFraction);
+        }
+        int64_t delay = forward ? stamp.reflectorRx - stamp.clientTx : now - stamp.clientTx;
+        if (m_hot.mode == MODE_ADAPTIVE)
+        {
+            delays.push_back(delay * 1e-9);
+        }
+        m_delaysTrace(stamp.seq,
+                      NanoSeconds(stamp.reflectorRx - stamp.clientTx),
+                      Simulator::Now() - reflectorTx);
+    }
+}
+
+void
+RandomNoiseClient::LatencyWindow::Push(double value)
+{
+    if (count < SIZE)
+    {
+        values[(first + count++) % SIZE] = value;
+    }
+    else
+    {
+        values[first] = value;
+        first = (first + 1) % SIZE;
+    }
+}
+
+double
+RandomNoiseClient::LatencyWindow::Get(uint32_t i) const
+{
+    return values[(first + i) % SIZE];
+}
+
+void
+RandomNoiseClient::AddLatencySamples(const double* delays, uint32_t n)
+{
+    NS_LOG_FUNCTION(this << n);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        double delay = delays[i];
+        m_latencyTrace(delay);
+        m_latencies.Push(delay);
+
+        double mean = 0;
+        for (uint32_t j = 0; j < m_latencies.count; j++)
+        {
+            mean += m_latencies.Get(j);
+        }
+        mean = mean / m_latencies.count;
+
+        double standard_deviation = 0;
+        for (uint32_t j = 0; j < m_latencies.count; j++)
+        {
+            standard_deviation += (m_latencies.Get(j) - mean) * (m_latencies.Get(j) - mean);
+        }
+        standard_deviation = sqrt(standard_deviation / m_latencies.count);
 
+        m_meanLatencies.Push(mean);
+        m_stdevLatencies.Push(standard_deviation);
 
-        //  strcat(command, a.c_str());
-          strcat(command, "\')");
-        //  std::cout << command << std::endl;
-          //std::cout << command << std::endl;
-          Py_Initialize();
+        if (m_config->predictorBackend == PREDICTOR_NATIVE)
+        {
+            MASTICC_PROFILE_SCOPE(INFERENCE);
+            // the predictor keeps the last LstmWindow samples; the smoothed
+            // latency is the mean and the derivatives and loss are not tracked
+            // online
+            double features[8] = {mean, standard_deviation, delay, mean, 0, 0, 0, m_ceFraction};
+            m_predictor.Step(features);
+        }
+    }
 
-          PyRun_SimpleString(command);
-          Py_Finalize();
+    MASTICC_PROFILE_SCOPE(INFERENCE);
+    if (m_config->predictorBackend == PREDICTOR_NATIVE)
+    {
+        m_hot.predictedRatio = m_predictor.Predict();
+        if (m_config->ecnFeedback)
+        {
+            // the marks react before the latency does, back off like DCTCP
+            m_hot.predictedRatio *= 1 - m_config->ecnBackoff * m_ceFraction;
+        }
+        if (m_trainer)
+        {
+            m_trainer->AddSample(m_predictor.GetHeadInput(), m_trainer->TakeFreeRatio(m_labelMark));
+        }
+    }
+    else
+    {
+        PredictWithPython();
+    }
+    m_predictionTrace(m_hot.predictedRatio);
+}
 
-          std::ifstream inputFile("pythonResult.txt");
-          if (!inputFile.is_open()){
-            std::cout << "INPUT FILE WAS NOT OPENED" << std::endl;
-          }else{
-            std::string line;
-            getline(inputFile, line);
-            predicted_bandwith_ratio = std::stod(line);
+void
+RandomNoiseClient::PredictWithPython()
+{
+    NS_LOG_FUNCTION(this);
 
-          //  std::cout << " * Predicted bandwith ratio: " << predicted_bandwith_ratio << std::endl;
-          }
+    std::ostringstream command;
+    command << "import os;os.system('python3 " << m_config->predictorScript << " ";
+    if (m_meanLatencies.count == LatencyWindow::SIZE)
+    {
+        command << LatencyWindow::SIZE;
+        for (uint32_t i = 0; i < LatencyWindow::SIZE; i++)
+        {
+            command << " " << std::to_string(m_meanLatencies.Get(i)) << " "
+                    << std::to_string(m_stdevLatencies.Get(i)) << " "
+                    << std::to_string(m_latencies.Get(i)) << " 0 0 0 0";
         }
     }
+    command << "')";
+
+    Py_Initialize();
+    PyRun_SimpleString(command.str().c_str());
+    Py_Finalize();
+
+    std::ifstream inputFile("pythonResult.txt");
+    if (!inputFile.is_open()){
+      std::cout << "INPUT FILE WAS NOT OPENED" << std::endl;
+    }else{
+      std::string line;
+      getline(inputFile, line);
+      m_hot.predictedRatio = std::stod(line);
+    }
 }
 
 } // Namespace ns3
@@ -21,17 +21,24 @@
  #include<fstream>
 
 #include "ns3/application.h"
+#include "ns3/data-rate.h"
 #include "ns3/event-id.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/ptr.h"
 #include "ns3/traced-callback.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/simple-ref-count.h"
 #include "ns3/double.h"
+#include "ns3/echo_timestamp_header.h"
+#include "ns3/lstm_predictor.h"
+#include "ns3/noise_trace.h"
+#include "ns3/online_trainer.h"
 
- #include<map>
- #include<list>
  #include </usr/include/python3.10/Python.h>
 
+#include <string>
+#include <vector>
+
 namespace ns3
 {
 
@@ -57,30 +64,76 @@ class RandomNoiseClient : public Application
 
     ~RandomNoiseClient() override;
 
-    uint32_t uid_probe = 0;
-    bool waiting_on_probe = false;
-    int msg_counter_since_probe = 0;
-    int nr_messages_between_probes = 3;
+    /// Implementation used to predict the available bandwidth ratio
+    enum PredictorBackend
+    {
+        PREDICTOR_NATIVE, //!< In-process LstmPredictor
+        PREDICTOR_PYTHON, //!< Legacy useLSTM.py run through the embedded interpreter
+    };
+
+    /// Distribution of the noise packet sizes
+    enum SizeDistribution
+    {
+        SIZE_NORMAL,    //!< Normal, with the absolute value of negative draws
+        SIZE_LOGNORMAL, //!< Log-normal with the same mean and variance
+        SIZE_BIMODAL,   //!< Small or large packets
+        SIZE_EMPIRICAL, //!< Sizes drawn from a given CDF
+    };
+
+    /// Change of the TargetRate over time
+    enum RateProfile
+    {
+        PROFILE_CONSTANT, //!< TargetRate all the time
+        PROFILE_STEP,     //!< TargetRate, then ProfileRate after ProfilePeriod
+        PROFILE_RAMP,     //!< Linear from TargetRate to ProfileRate in ProfilePeriod
+        PROFILE_SINUSOID, //!< Between TargetRate and ProfileRate, period ProfilePeriod
+    };
+
+    /// Delay fed to the predictor
+    enum LatencySignal
+    {
+        SIGNAL_RTT,     //!< Round trip time of the echoes
+        SIGNAL_FORWARD, //!< One-way delay to the EchoReflector, needs Timestamps
+    };
 
-    std::map<uint32_t, double> messageTimings;
-    std::list<double> latencies;
-    std::list<double> mean_latencies;
-    std::list<double> stdev_latency;
-    uint32_t view_size = 3;
+    /**
+     * TracedCallback signature for bandwidth predictions.
+     *
+     * \param ratio predicted available bandwidth ratio, before clamping to [0, 1]
+     */
+    typedef void (*PredictionTracedCallback)(double ratio);
 
-    double current_mean_latency = 0;
-    double current_stdev_latency = 0;
-    double current_latency = 0;
-    double current_latency_smoothed = 0;
-    double current_first_order_deriv = 0;
-    double current_second_order_deriv = 0;
-    double current_packet_loss = 0;
+    /**
+     * TracedCallback signature for the delays of a reply from an EchoReflector.
+     *
+     * \param seq sequence number of the request
+     * \param forward one-way delay from the client to the reflector
+     * \param reverse one-way delay of the reply, batching wait included
+     */
+    typedef void (*DelaysTracedCallback)(uint32_t seq, Time forward, Time reverse);
 
-    double predicted_bandwith_ratio = 0;
-    double optimal_speed = 0.0001;
-    double slowest_speed = 1;
+    /**
+     * TracedCallback signature for the latency samples of the adaptive client.
+     *
+     * \param latency the RTT, or the forward delay with LatencySignal Forward (s)
+     */
+    typedef void (*LatencyTracedCallback)(double latency);
+
+    /// Memory held by one client, see GetMemoryUsage
+    struct MemoryUsage
+    {
+        uint32_t object{0};          //!< The client object itself
+        uint32_t config{0};          //!< Its share of the configuration
+        uint32_t randomVariables{0}; //!< Random variables and their RNG streams
+        uint32_t sendTimes{0};       //!< Send times of the unanswered packets
+        uint32_t predictor{0};       //!< LSTM state of the Native predictor
+
+        /**
+         * \return the sum of all the parts (bytes)
+         */
+        uint32_t GetTotal() const;
+    };
 
-    double act_as_noise_client = true;
     /**
      * \brief set the remote address and port
      * \param ip remote IP address
@@ -162,10 +215,177 @@ class RandomNoiseClient : public Application
      */
     void SetFill(uint8_t* fill, uint32_t fillSize, uint32_t dataSize);
 
+    /**
+     * Assign a fixed random variable stream number to the random variables
+     * used by this client.
+     *
+     * \param stream first stream index to use
+     * \return the number of stream indices assigned by this client
+     */
+    int64_t AssignStreams(int64_t stream);
+
+    /**
+     * \brief Measure the memory held by this client.
+     *
+     * The shared model and noise trace are not counted; the configuration
+     * is divided among the clients sharing it.
+     *
+     * \return the usage, in bytes
+     */
+    MemoryUsage GetMemoryUsage() const;
+
   protected:
     void DoDispose() override;
 
   private:
+    /// Send pattern of the client, fixed when it starts
+    enum SendMode : uint8_t
+    {
+        MODE_INTERVAL, //!< Noise with exponential intervals of mean IntervalMean
+        MODE_RATE,     //!< Noise following TargetRate and the RateProfile
+        MODE_TRACE,    //!< Noise replayed from TraceFile
+        MODE_ADAPTIVE, //!< Paced by the predicted available bandwidth
+    };
+
+    /**
+     * \brief Attribute values shared by the clients configured alike.
+     *
+     * Configurations are immutable once in use: setting an attribute copies
+     * the client's configuration, changes the copy and looks it up among the
+     * live configurations, so the clients created by one helper end up
+     * sharing a single instance.
+     */
+    struct Config : public SimpleRefCount<Config>
+    {
+        uint32_t count{0};                                   //!< Maximum number of packets to send
+        Time interval{Seconds(1)};                           //!< Packet inter-send time
+        uint8_t tos{0};                                      //!< The packets Type of Service
+        uint32_t size{100};                                  //!< Size of the echo data
+        std::vector<uint8_t> fill;                           //!< Echo data set with SetFill
+        double packetSizeMean{1000};                         //!< Mean of the size distribution
+        double packetSizeVariance{200};                      //!< Variance of the size distribution
+        double intervalMean{1};                              //!< Mean noise interval (s)
+        DataRate targetRate{0};                              //!< Average noise rate, 0 for none
+        SizeDistribution sizeDistribution{SIZE_NORMAL};      //!< Distribution of the packet sizes
+        uint32_t bimodalSmallSize{64};                       //!< Small size of SIZE_BIMODAL
+        uint32_t bimodalLargeSize{1472};                     //!< Large size of SIZE_BIMODAL
+        double bimodalLargeProbability{0.5};                 //!< Large SIZE_BIMODAL probability
+        std::string empiricalSizes{"64:0.5,576:0.6,1472:1"}; //!< CDF of SIZE_EMPIRICAL
+        uint32_t burstSize{1};                               //!< Noise packets per send event
+        RateProfile rateProfile{PROFILE_CONSTANT};           //!< Change of the rate over time
+        DataRate profileRate{0};                             //!< Rate the profile moves to
+        Time profilePeriod{Seconds(10)};                     //!< Time scale of the profile
+        std::string traceFile;                               //!< Noise trace, empty for none
+        bool traceLoop{true};                                //!< Restart the trace at its end
+        double traceTimeScale{1};                            //!< Factor of the trace intervals
+        PredictorBackend predictorBackend{PREDICTOR_NATIVE}; //!< Prediction implementation
+        std::string modelFile{"masticc/savedModel.txt"};     //!< Model of PREDICTOR_NATIVE
+        std::string scalerFile;                              //!< Scaler replacing the model's, empty for none
+        uint32_t lstmWindow{10};                             //!< Samples per prediction, 0 for all
+        std::string predictorScript{"masticc/useLSTM.py"};   //!< useLSTM.py for PREDICTOR_PYTHON
+        double pacingExponent{6};                            //!< Exponent of the pacing law
+        bool timestamps{false};                              //!< Stamp requests for an EchoReflector
+        LatencySignal latencySignal{SIGNAL_RTT};             //!< Delay fed to the predictor
+        bool ecnFeedback{false};                             //!< Send ECT(0), use the CE marks
+        double ecnGain{1.0 / 16};                            //!< Weight of a mark in m_ceFraction
+        double ecnBackoff{0.5};                              //!< Ratio cut at a CE fraction of 1
+
+        /**
+         * \param other another configuration
+         * \return true if every value is the same
+         */
+        bool operator==(const Config& other) const;
+
+        /**
+         * \return the bytes held by the configuration, strings included
+         */
+        uint32_t GetSize() const;
+
+        /**
+         * \return a hash of every value, equal for configurations that compare equal
+         */
+        std::size_t Hash() const;
+    };
+
+    /**
+     * \brief Attribute accessor of a Config field.
+     * \tparam V the AttributeValue type
+     * \tparam T the field type
+     */
+    template <typename V, typename T>
+    class ConfigAccessor;
+
+    /**
+     * \brief Make an accessor for a Config field.
+     * \tparam V the AttributeValue type
+     * \tparam T the field type
+     * \param field the field
+     * \return the accessor
+     */
+    template <typename V, typename T>
+    static Ptr<const AttributeAccessor> MakeConfigAccessor(T Config::*field);
+
+    /**
+     * \brief Look a configuration up among the live ones.
+     * \param config a configuration no client uses yet
+     * \return an equal configuration already in use, or config
+     */
+    static Ptr<const Config> InternConfig(Ptr<Config> config);
+
+    /**
+     * \return a private copy of the configuration, to change and pass to SetConfig
+     */
+    Ptr<Config> CopyConfig() const;
+
+    /**
+     * \param config the new configuration, shared if an equal one is in use
+     */
+    void SetConfig(Ptr<Config> config);
+
+    /**
+     * \brief Fixed window of the latest samples.
+     */
+    struct LatencyWindow
+    {
+        static constexpr uint32_t SIZE = 3; //!< Samples kept, the view size of useLSTM.py
+
+        double values[SIZE]; //!< Ring of samples
+        uint8_t first{0};    //!< Index of the oldest sample
+        uint8_t count{0};    //!< Number of samples
+
+        /**
+         * \param value the new sample, replacing the oldest one when full
+         */
+        void Push(double value);
+
+        /**
+         * \param i position, 0 for the oldest sample
+         * \return the sample
+         */
+        double Get(uint32_t i) const;
+    };
+
+    /// Send time of an unanswered packet of the adaptive client
+    struct SendRecord
+    {
+        uint64_t uid; //!< Packet uid
+        double time;  //!< Send time (s)
+    };
+
+    /// State touched by every Send and HandleRead, kept in one cache line
+    struct alignas(64) HotState
+    {
+        double predictedRatio{0};     //!< Latest predicted available bandwidth ratio
+        double meanPacketSize{0};     //!< Mean of the size distribution
+        double rateInterval{0};       //!< Mean interval between bursts at the peak rate (s)
+        double peakRate{0};           //!< Highest rate of the RateProfile (bit/s)
+        uint32_t sent{0};             //!< Counter for sent packets
+        SendMode mode{MODE_INTERVAL}; //!< Send pattern
+        bool thinning{false};         //!< The RateProfile is followed by thinning
+        bool replay{false};           //!< Sizes, and noise intervals, come from the trace
+        EventId sendEvent;            //!< Event to send the next packet
+    };
+
     void StartApplication() override;
     void StopApplication() override;
 
@@ -175,10 +395,70 @@ class RandomNoiseClient : public Application
      */
     void ScheduleTransmit(Time dt);
     /**
-     * \brief Send a packet
+     * \brief Send a packet, or a burst of noise packets, and schedule the
+     * next send.
      */
     void Send();
 
+    /**
+     * \brief Send one packet and record its send time.
+     * \param packetSize payload size
+     */
+    void SendPacket(uint32_t packetSize);
+
+    /**
+     * \brief Set up the size and interval distributions from the attributes.
+     */
+    void ConfigureNoise();
+
+    /**
+     * \return the size of the next noise packet, from the trace or the
+     * SizeDistribution
+     */
+    uint32_t NextPacketSize();
+
+    /**
+     * \brief Evaluate the RateProfile at the current time.
+     * \return the noise rate (bit/s)
+     */
+    double GetCurrentRate() const;
+
+    /**
+     * \return the highest rate of the RateProfile (bit/s)
+     */
+    double GetPeakRate() const;
+
+    /**
+     * \brief Create the random variables the send mode draws from.
+     */
+    void CreateRandomVariables();
+
+    /**
+     * \brief Remember the send time of a packet of the adaptive client.
+     * \param uid the packet uid
+     * \param time the send time (s)
+     */
+    void RecordSendTime(uint64_t uid, double time);
+
+    /**
+     * \brief Find and forget the send time of an echoed packet.
+     *
+     * Echoes come back in order, so older unanswered packets are lost and
+     * forgotten as well.
+     *
+     * \param uid the packet uid
+     * \param time set to the send time (s)
+     * \return false if the packet is not a pending one
+     */
+    bool TakeSendTime(uint64_t uid, double& time);
+
+    /**
+     * \brief Take the timestamps, and the CE marks, of a reply from an EchoReflector.
+     * \param packet the reply, starting with an EchoTimestampHeader
+     * \param delays the latency samples of the adaptive client are added here
+     */
+    void HandleStampedReply(Ptr<Packet> packet, std::vector<double>& delays);
+
     /**
      * \brief Handle a packet reception.
      *
@@ -188,26 +468,79 @@ class RandomNoiseClient : public Application
      */
     void HandleRead(Ptr<Socket> socket);
 
-    uint32_t m_count; //!< Maximum number of packets the application will send
-    Time m_interval;  //!< Packet inter-send time
-    uint32_t m_size;  //!< Size of the sent packet
+    /**
+     * \brief Update the latency windows and the prediction with the round
+     * trip times of a batch of echoes.
+     *
+     * The native predictor takes every sample, but the prediction (and
+     * the Prediction trace) runs once per batch.
+     *
+     * \param delays round trip times, or forward delays, in arrival order (s)
+     * \param n number of samples
+     */
+    void AddLatencySamples(const double* delays, uint32_t n);
+
+    /**
+     * \brief Update the predicted ratio by running useLSTM.py on the
+     * current windows (PREDICTOR_PYTHON backend).
+     */
+    void PredictWithPython();
 
-    uint32_t m_dataSize; //!< packet payload size (must be equal to m_size)
-    uint8_t* m_data;     //!< packet payload data
+    /**
+     * \brief Set the model of the Native predictor.
+     *
+     * Once the client runs the new model is loaded right away, with a fresh
+     * hidden state.
+     *
+     * \param modelFile model exported by exportLSTM.py
+     */
+    void SetModelFile(std::string modelFile);
 
-    uint32_t m_sent;       //!< Counter for sent packets
-    Ptr<Socket> m_socket;  //!< Socket
-    Address m_peerAddress; //!< Remote peer address
-    uint16_t m_peerPort;   //!< Remote peer port
-    uint8_t m_tos;         //!< The packets Type of Service
-    EventId m_sendEvent;   //!< Event to send the next packet
+    /**
+     * \return the model file of the Native predictor
+     */
+    std::string GetModelFile() const;
 
-    // random distributions
-    double m_packetSizeMean;
-    double m_packetSizeVariance;
-    double m_intervalMean;
-    Ptr<NormalRandomVariable> m_normalRand;
-    Ptr<ExponentialRandomVariable> m_exponentialRand;
+    /**
+     * \brief Load the ModelFile into the predictor.
+     */
+    void LoadModel();
+
+    HotState m_hot;             //!< Per-send state
+    Ptr<const Config> m_config; //!< Attribute values, possibly shared
+
+    Ptr<Socket> m_socket;          //!< Socket
+    Address m_peerAddress;         //!< Remote peer address, per client unlike the Config
+    uint16_t m_peerPort;           //!< Remote peer port
+    Address m_peerSocketAddress;   //!< Peer address and port, resolved in StartApplication
+    Address m_localAddress;        //!< Local socket address, resolved in StartApplication
+    std::string m_peerDescription; //!< Peer for log messages, only built with LOG_INFO enabled
+
+    // random distributions, only the ones the send mode needs are created
+    Ptr<NormalRandomVariable> m_normalRand;           //!< Normal sizes
+    Ptr<ExponentialRandomVariable> m_exponentialRand; //!< Noise intervals
+    Ptr<UniformRandomVariable> m_uniformRand;         //!< Bimodal sizes and rate profile thinning
+    Ptr<RandomVariableStream> m_sizeRand;             //!< LogNormal or Empirical sizes
+    int64_t m_stream;                                 //!< First assigned stream, -1 if not assigned
+    Time m_profileStart;                              //!< Time the rate profile started
+
+    // trace replay
+    uint64_t m_traceOffset;       //!< First replayed trace packet
+    NoiseTraceReader m_trace;     //!< Position in the shared trace mapping
+    NoiseTraceRecord m_traceNext; //!< Packet sent by the next Send
+
+    // bandwidth prediction
+    LatencyWindow m_latencies;           //!< Latest delays, see LatencySignal
+    LatencyWindow m_meanLatencies;       //!< Means of m_latencies
+    LatencyWindow m_stdevLatencies;      //!< Standard deviations of m_latencies
+    std::vector<SendRecord> m_sendTimes; //!< Unanswered packets, oldest first from m_sendFirst
+    uint32_t m_sendFirst;                //!< First pending entry of m_sendTimes
+    double m_ceFraction;                 //!< Moving average of the CE marked requests
+    LstmPredictor m_predictor;           //!< Per-client LSTM state
+    Ptr<OnlineTrainer> m_trainer;        //!< Online fine-tuning, shared between clients
+    OnlineTrainer::Mark m_labelMark;     //!< Start of the label of the next prediction
+
+    uint32_t m_profileClient; //!< MasticcProfiler slot, with MASTICC_PROFILING
 
     /// Callbacks for tracing the packet Tx events
     TracedCallback<Ptr<const Packet>> m_txTrace;
@@ -220,6 +553,15 @@ class RandomNoiseClient : public Application
 
     /// Callbacks for tracing the packet Rx events, includes source and destination addresses
     TracedCallback<Ptr<const Packet>, const Address&, const Address&> m_rxTraceWithAddresses;
+
+    /// Callbacks for tracing the bandwidth predictions of the adaptive client
+    TracedCallback<double> m_predictionTrace;
+
+    /// Callbacks for tracing the one-way delays measured with an EchoReflector
+    TracedCallback<uint32_t, Time, Time> m_delaysTrace;
+
+    /// Callbacks for tracing the latency samples given to the predictor
+    TracedCallback<double> m_latencyTrace;
 };
 
 } // namespace ns3
@@ -0,0 +1,146 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/shared_result_aggregator.h"
+
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <limits>
+#include <new>
+#include <string.h>
+#include <sys/mman.h>
+
+namespace ns3
+{
+
+namespace
+{
+
+/**
+ * \brief Atomically add to a double.
+ */
+void
+AtomicAdd(std::atomic<double>& target, double value)
+{
+    double current = target.load(std::memory_order_relaxed);
+    while (!target.compare_exchange_weak(current, current + value, std::memory_order_relaxed))
+    {
+    }
+}
+
+/**
+ * \brief Atomically replace a double if the new value compares better.
+ */
+template <typename Better>
+void
+AtomicUpdate(std::atomic<double>& target, double value, Better better)
+{
+    double current = target.load(std::memory_order_relaxed);
+    while (better(value, current) &&
+           !target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+} // namespace
+
+SharedResultAggregator::SharedResultAggregator(uint32_t nMetrics)
+    : m_nMetrics(nMetrics)
+{
+    size_t size = sizeof(Accumulator) * std::max<uint32_t>(nMetrics, 1);
+    void* shared = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    NS_ABORT_MSG_IF(shared == MAP_FAILED, "Could not map " << size << " bytes: " << strerror(errno));
+    m_accumulators = static_cast<Accumulator*>(shared);
+    for (uint32_t i = 0; i < nMetrics; i++)
+    {
+        Accumulator* accumulator = new (&m_accumulators[i]) Accumulator;
+        accumulator->count = 0;
+        accumulator->sum = 0;
+        accumulator->sumSquares = 0;
+        accumulator->min = std::numeric_limits<double>::infinity();
+        accumulator->max = -std::numeric_limits<double>::infinity();
+    }
+}
+
+SharedResultAggregator::~SharedResultAggregator()
+{
+    munmap(m_accumulators, sizeof(Accumulator) * std::max<uint32_t>(m_nMetrics, 1));
+}
+
+void
+SharedResultAggregator::Add(uint32_t metric, double value)
+{
+    NS_ASSERT(metric < m_nMetrics);
+    Accumulator& accumulator = m_accumulators[metric];
+    AtomicAdd(accumulator.sum, value);
+    AtomicAdd(accumulator.sumSquares, value * value);
+    AtomicUpdate(accumulator.min, value, [](double a, double b) { return a < b; });
+    AtomicUpdate(accumulator.max, value, [](double a, double b) { return a > b; });
+    // count last, so a reader never sees a count without its sample
+    accumulator.count.fetch_add(1, std::memory_order_release);
+}
+
+uint64_t
+SharedResultAggregator::GetCount(uint32_t metric) const
+{
+    NS_ASSERT(metric < m_nMetrics);
+    return m_accumulators[metric].count.load(std::memory_order_acquire);
+}
+
+double
+SharedResultAggregator::GetSum(uint32_t metric) const
+{
+    NS_ASSERT(metric < m_nMetrics);
+    return m_accumulators[metric].sum.load(std::memory_order_relaxed);
+}
+
+double
+SharedResultAggregator::GetMean(uint32_t metric) const
+{
+    uint64_t count = GetCount(metric);
+    return count > 0 ? GetSum(metric) / count : 0;
+}
+
+double
+SharedResultAggregator::GetStdev(uint32_t metric) const
+{
+    uint64_t n = GetCount(metric);
+    if (n < 2)
+    {
+        return 0;
+    }
+    double mean = GetMean(metric);
+    double sumSquares = m_accumulators[metric].sumSquares.load(std::memory_order_relaxed);
+    return std::sqrt(std::max((sumSquares - n * mean * mean) / (n - 1), 0.0));
+}
+
+double
+SharedResultAggregator::GetMin(uint32_t metric) const
+{
+    NS_ASSERT(metric < m_nMetrics);
+    return m_accumulators[metric].min.load(std::memory_order_relaxed);
+}
+
+double
+SharedResultAggregator::GetMax(uint32_t metric) const
+{
+    NS_ASSERT(metric < m_nMetrics);
+    return m_accumulators[metric].max.load(std::memory_order_relaxed);
+}
+
+} // namespace ns3
@@ -0,0 +1,113 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SHARED_RESULT_AGGREGATOR_H
+#define SHARED_RESULT_AGGREGATOR_H
+
+#include "ns3/simple-ref-count.h"
+
+#include <atomic>
+#include <stdint.h>
+
+namespace ns3
+{
+
+/**
+ * \ingroup randomnoise
+ * \brief Lock-free statistics shared by forked worker processes.
+ *
+ * The accumulators live in an anonymous shared mapping created by the
+ * constructor, so every process forked afterwards adds to the same ones.
+ * Add() only uses atomic read-modify-write operations and never blocks, so a
+ * worker that dies cannot leave the aggregator locked.
+ */
+class SharedResultAggregator : public SimpleRefCount<SharedResultAggregator>
+{
+  public:
+    /**
+     * \param nMetrics number of metrics to aggregate
+     */
+    explicit SharedResultAggregator(uint32_t nMetrics);
+    ~SharedResultAggregator();
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    SharedResultAggregator(const SharedResultAggregator&) = delete;
+    SharedResultAggregator& operator=(const SharedResultAggregator&) = delete;
+
+    /**
+     * \brief Add a sample of a metric.
+     * \param metric metric index
+     * \param value the sample
+     */
+    void Add(uint32_t metric, double value);
+
+    /**
+     * \param metric metric index
+     * \return the number of samples
+     */
+    uint64_t GetCount(uint32_t metric) const;
+
+    /**
+     * \param metric metric index
+     * \return the sum of the samples
+     */
+    double GetSum(uint32_t metric) const;
+
+    /**
+     * \param metric metric index
+     * \return the mean of the samples, 0 without samples
+     */
+    double GetMean(uint32_t metric) const;
+
+    /**
+     * \param metric metric index
+     * \return the sample standard deviation, 0 with fewer than two samples
+     */
+    double GetStdev(uint32_t metric) const;
+
+    /**
+     * \param metric metric index
+     * \return the smallest sample
+     */
+    double GetMin(uint32_t metric) const;
+
+    /**
+     * \param metric metric index
+     * \return the largest sample
+     */
+    double GetMax(uint32_t metric) const;
+
+  private:
+    /// Accumulators of one metric
+    struct Accumulator
+    {
+        std::atomic<uint64_t> count;    //!< Samples added
+        std::atomic<double> sum;        //!< Sum of the samples
+        std::atomic<double> sumSquares; //!< Sum of the squared samples
+        std::atomic<double> min;        //!< Smallest sample
+        std::atomic<double> max;        //!< Largest sample
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free &&
+                      std::atomic<double>::is_always_lock_free,
+                  "Shared accumulators must be lock-free to work across processes");
+
+    uint32_t m_nMetrics;         //!< Number of metrics
+    Accumulator* m_accumulators; //!< Shared mapping, one accumulator per metric
+};
+
+} // namespace ns3
+
+#endif /* SHARED_RESULT_AGGREGATOR_H */
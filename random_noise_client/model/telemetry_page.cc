@@ -0,0 +1,406 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/telemetry_page.h"
+
+#include "ns3/abort.h"
+#include "ns3/application-container.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/random_noise_client.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("TelemetryPage");
+
+NS_OBJECT_ENSURE_REGISTERED(TelemetryPage);
+
+size_t
+TelemetryHeader::GetPageSize(uint32_t maxClients)
+{
+    return sizeof(TelemetryHeader) + sizeof(TelemetryClient) * maxClients;
+}
+
+TelemetryClient*
+TelemetryHeader::GetClients()
+{
+    return reinterpret_cast<TelemetryClient*>(this + 1);
+}
+
+const TelemetryClient*
+TelemetryHeader::GetClients() const
+{
+    return reinterpret_cast<const TelemetryClient*>(this + 1);
+}
+
+void
+TelemetryPage::Probe::Tx(Ptr<const Packet> packet)
+{
+    sent++;
+    sentBits += packet->GetSize() * 8;
+}
+
+void
+TelemetryPage::Probe::Rx(Ptr<const Packet> packet)
+{
+    received++;
+}
+
+void
+TelemetryPage::Probe::Prediction(double ratio)
+{
+    adaptive = true;
+    predictedRatio = ratio;
+}
+
+void
+TelemetryPage::Probe::Latency(double latency)
+{
+    latencySum += latency;
+    latencyCount++;
+}
+
+TypeId
+TelemetryPage::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::TelemetryPage")
+            .SetParent<Object>()
+            .SetGroupName("Applications")
+            .AddConstructor<TelemetryPage>()
+            .AddAttribute("Interval",
+                          "Simulated time between two updates of the page",
+                          TimeValue(MilliSeconds(100)),
+                          MakeTimeAccessor(&TelemetryPage::m_interval),
+                          MakeTimeChecker(MilliSeconds(1)))
+            .AddAttribute("File",
+                          "File of the page, empty for /dev/shm/masticc-<pid>.telemetry",
+                          StringValue(""),
+                          MakeStringAccessor(&TelemetryPage::m_file),
+                          MakeStringChecker());
+    return tid;
+}
+
+TelemetryPage::TelemetryPage()
+    : m_page(nullptr),
+      m_startEvents(0),
+      m_lastEvents(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+TelemetryPage::~TelemetryPage()
+{
+    NS_LOG_FUNCTION(this);
+    Close();
+}
+
+void
+TelemetryPage::AddClient(Ptr<RandomNoiseClient> client)
+{
+    NS_LOG_FUNCTION(this << client);
+    NS_ABORT_MSG_IF(m_page, "Clients must be added to the telemetry page before Start");
+    Ptr<Probe> probe = Create<Probe>();
+    probe->node = client->GetNode()->GetId();
+    // the probes live as long as the page, which outlives the simulation
+    client->TraceConnectWithoutContext("Tx", MakeCallback(&Probe::Tx, PeekPointer(probe)));
+    client->TraceConnectWithoutContext("Rx", MakeCallback(&Probe::Rx, PeekPointer(probe)));
+    client->TraceConnectWithoutContext("Prediction",
+                                       MakeCallback(&Probe::Prediction, PeekPointer(probe)));
+    client->TraceConnectWithoutContext("Latency",
+                                       MakeCallback(&Probe::Latency, PeekPointer(probe)));
+    m_probes.push_back(probe);
+}
+
+void
+TelemetryPage::AddClients(const ApplicationContainer& apps)
+{
+    NS_LOG_FUNCTION(this);
+    for (auto it = apps.Begin(); it != apps.End(); ++it)
+    {
+        Ptr<RandomNoiseClient> client = DynamicCast<RandomNoiseClient>(*it);
+        if (client)
+        {
+            AddClient(client);
+        }
+    }
+}
+
+void
+TelemetryPage::Start()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ABORT_MSG_IF(m_page, "The telemetry page is already started");
+    if (m_file.empty())
+    {
+        m_file = "/dev/shm/masticc-" + std::to_string(getpid()) + ".telemetry";
+    }
+    uint32_t maxClients = m_probes.size();
+    size_t size = TelemetryHeader::GetPageSize(maxClients);
+    // a new file rather than a truncated one: readers still mapping the page
+    // of a previous run keep it instead of faulting past its end
+    unlink(m_file.c_str());
+    int fd = open(m_file.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    NS_ABORT_MSG_IF(fd == -1, "Could not create " << m_file << ": " << strerror(errno));
+    if (ftruncate(fd, size) == -1)
+    {
+        close(fd);
+        NS_FATAL_ERROR("Could not size " << m_file << ": " << strerror(errno));
+    }
+    void* shared = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    NS_ABORT_MSG_IF(shared == MAP_FAILED, "Could not map " << m_file << ": " << strerror(errno));
+
+    // ftruncate zero filled the page, readers ignore it until the magic is set
+    m_page = new (shared) TelemetryHeader;
+    m_page->version = TelemetryHeader::VERSION;
+    m_page->maxClients = maxClients;
+    m_page->pid = getpid();
+    m_page->sequence.store(0, std::memory_order_relaxed);
+    TelemetryClient* clients = m_page->GetClients();
+    for (uint32_t i = 0; i < maxClients; i++)
+    {
+        clients[i].node = m_probes[i]->node;
+    }
+    m_page->magic.store(TelemetryHeader::MAGIC, std::memory_order_release);
+
+    m_start = std::chrono::steady_clock::now();
+    m_lastWall = m_start;
+    m_startTime = Simulator::Now();
+    m_startEvents = Simulator::GetEventCount();
+    m_lastUpdate = m_startTime;
+    m_lastEvents = m_startEvents;
+    for (const Ptr<Probe>& probe : m_probes)
+    {
+        probe->lastSentBits = probe->sentBits;
+    }
+    NS_LOG_INFO("Telemetry of " << maxClients << " clients in " << m_file);
+    Update();
+}
+
+void
+TelemetryPage::Stop()
+{
+    NS_LOG_FUNCTION(this);
+    if (m_page)
+    {
+        Simulator::Cancel(m_updateEvent);
+        Publish(true);
+    }
+}
+
+std::string
+TelemetryPage::GetFile() const
+{
+    return m_file;
+}
+
+void
+TelemetryPage::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    Simulator::Cancel(m_updateEvent);
+    Close();
+    m_probes.clear();
+    Object::DoDispose();
+}
+
+void
+TelemetryPage::Update()
+{
+    Publish(false);
+    m_updateEvent = Simulator::Schedule(m_interval, &TelemetryPage::Update, this);
+}
+
+void
+TelemetryPage::Publish(bool finished)
+{
+    NS_LOG_FUNCTION(this << finished);
+    auto wall = std::chrono::steady_clock::now();
+    uint64_t events = Simulator::GetEventCount();
+    Time now = Simulator::Now();
+    double wallInterval = std::chrono::duration<double>(wall - m_lastWall).count();
+    double simInterval = (now - m_lastUpdate).GetSeconds();
+
+    // the only writer: odd sequence, writes, even sequence; the release
+    // fence keeps the writes of the update after the odd sequence
+    uint64_t sequence = m_page->sequence.load(std::memory_order_relaxed);
+    m_page->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    TelemetryState& state = m_page->state;
+    state.nClients = m_probes.size();
+    state.finished = finished;
+    state.events = events;
+    state.simTime = now.GetSeconds();
+    state.wallTime = std::chrono::duration<double>(wall - m_start).count();
+    if (finished)
+    {
+        // the final rates cover the whole run
+        state.eventsPerSecond = state.wallTime > 0 ? (events - m_startEvents) / state.wallTime : 0;
+        state.simSpeed = state.wallTime > 0 ? (now - m_startTime).GetSeconds() / state.wallTime : 0;
+    }
+    else if (wallInterval > 0)
+    {
+        state.eventsPerSecond = (events - m_lastEvents) / wallInterval;
+        state.simSpeed = simInterval / wallInterval;
+    }
+    TelemetryClient* clients = m_page->GetClients();
+    for (uint32_t i = 0; i < m_probes.size(); i++)
+    {
+        Probe& probe = *m_probes[i];
+        TelemetryClient& client = clients[i];
+        client.adaptive = probe.adaptive;
+        client.sent = probe.sent;
+        client.received = probe.received;
+        if (simInterval > 0)
+        {
+            client.sendRate = (probe.sentBits - probe.lastSentBits) / simInterval;
+            probe.lastSentBits = probe.sentBits;
+        }
+        client.predictedRatio = probe.predictedRatio;
+        if (probe.latencyCount > 0)
+        {
+            // kept until the next interval with samples
+            client.meanLatency = probe.latencySum / probe.latencyCount;
+        }
+        client.loss = probe.sent > 0 && probe.received < probe.sent
+                          ? 1 - static_cast<double>(probe.received) / probe.sent
+                          : 0;
+        probe.latencySum = 0;
+        probe.latencyCount = 0;
+    }
+
+    m_page->sequence.store(sequence + 2, std::memory_order_release);
+
+    m_lastWall = wall;
+    m_lastUpdate = now;
+    m_lastEvents = events;
+}
+
+void
+TelemetryPage::Close()
+{
+    if (m_page)
+    {
+        munmap(m_page, TelemetryHeader::GetPageSize(m_page->maxClients));
+        m_page = nullptr;
+    }
+}
+
+TelemetryReader::TelemetryReader()
+    : m_page(nullptr),
+      m_size(0)
+{
+}
+
+TelemetryReader::~TelemetryReader()
+{
+    Close();
+}
+
+bool
+TelemetryReader::Open(const std::string& file)
+{
+    NS_LOG_FUNCTION(this << file);
+    Close();
+
+    int fd = open(file.c_str(), O_RDONLY);
+    if (fd == -1)
+    {
+        NS_LOG_WARN("Could not open " << file);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1 || static_cast<size_t>(st.st_size) < sizeof(TelemetryHeader))
+    {
+        close(fd);
+        return false;
+    }
+    void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+    m_page = static_cast<const TelemetryHeader*>(data);
+    m_size = st.st_size;
+    if (m_page->magic.load(std::memory_order_acquire) != TelemetryHeader::MAGIC ||
+        m_page->version != TelemetryHeader::VERSION ||
+        m_size < TelemetryHeader::GetPageSize(m_page->maxClients))
+    {
+        NS_LOG_WARN(file << " is not a telemetry page");
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void
+TelemetryReader::Close()
+{
+    if (m_page)
+    {
+        munmap(const_cast<TelemetryHeader*>(m_page), m_size);
+        m_page = nullptr;
+        m_size = 0;
+    }
+}
+
+bool
+TelemetryReader::Read(TelemetrySnapshot& snapshot) const
+{
+    NS_ASSERT_MSG(m_page, "TelemetryReader has no page");
+    uint32_t maxClients = m_page->maxClients;
+    snapshot.pid = m_page->pid;
+    snapshot.clients.resize(maxClients);
+    // an update takes microseconds, a writer stuck on an odd sequence died
+    for (uint32_t attempt = 0; attempt < 100000; attempt++)
+    {
+        uint64_t before = m_page->sequence.load(std::memory_order_acquire);
+        if (before & 1)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        // the copy may be torn, it is only kept when the sequence did not move
+        std::memcpy(&snapshot.state, &m_page->state, sizeof(TelemetryState));
+        std::memcpy(snapshot.clients.data(),
+                    m_page->GetClients(),
+                    sizeof(TelemetryClient) * maxClients);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_page->sequence.load(std::memory_order_relaxed) == before)
+        {
+            snapshot.clients.resize(std::min(snapshot.state.nClients, maxClients));
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace ns3
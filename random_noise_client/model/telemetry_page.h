@@ -0,0 +1,277 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TELEMETRY_PAGE_H
+#define TELEMETRY_PAGE_H
+
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+class ApplicationContainer;
+class Packet;
+class RandomNoiseClient;
+
+/// Live state of one client in a telemetry page
+struct TelemetryClient
+{
+    uint32_t node;         //!< Node of the client
+    uint32_t adaptive;     //!< 1 once the client has made a prediction
+    uint64_t sent;         //!< Packets sent
+    uint64_t received;     //!< Packets received back
+    double sendRate;       //!< Sent over the last interval (bit/s of simulated time)
+    double predictedRatio; //!< Latest predicted available bandwidth ratio
+    double meanLatency;    //!< Mean latency sample over the last interval (s), 0 without
+    double loss;           //!< Fraction of the sent packets not received back
+};
+
+/// Live state of a simulation in a telemetry page
+struct TelemetryState
+{
+    uint32_t nClients;      //!< Valid entries of the client table
+    uint32_t finished;      //!< 1 once the simulation has stopped
+    uint64_t events;        //!< Events executed
+    double simTime;         //!< Simulated time (s)
+    double wallTime;        //!< Wall time since the start of the page (s)
+    double eventsPerSecond; //!< Events per wall second of the last interval (run once finished)
+    double simSpeed;        //!< Simulated seconds per wall second, like eventsPerSecond
+};
+
+/**
+ * \brief Start of a telemetry page, followed by the client table.
+ *
+ * The words before the sequence never change once the page is published.
+ * The state and the client table are guarded by the sequence, a seqlock: the
+ * single writer makes it odd, writes and makes it even again, and a reader
+ * retries its copy when the sequence was odd or changed meanwhile.
+ */
+struct TelemetryHeader
+{
+    static constexpr uint32_t MAGIC = 0x4d544c50; //!< "MTLP", written last
+    static constexpr uint32_t VERSION = 1;        //!< Layout version
+
+    std::atomic<uint32_t> magic;    //!< MAGIC once the page is initialized
+    uint32_t version;               //!< VERSION
+    uint32_t maxClients;            //!< Entries of the client table
+    int32_t pid;                    //!< Process of the simulation
+    std::atomic<uint64_t> sequence; //!< Seqlock of the state and the client table
+    TelemetryState state;           //!< Guarded by the sequence
+
+    /**
+     * \param maxClients entries of the client table
+     * \return the size of a page (bytes)
+     */
+    static size_t GetPageSize(uint32_t maxClients);
+
+    /**
+     * \return the client table following the header
+     */
+    TelemetryClient* GetClients();
+
+    /**
+     * \return the client table following the header
+     */
+    const TelemetryClient* GetClients() const;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "The seqlock must be lock-free to work across processes");
+
+/**
+ * \ingroup randomnoise
+ * \brief Publishes the live state of a simulation in a shared memory page.
+ *
+ * Every Interval of simulated time the page is updated with the simulated
+ * time, the events per wall second and, per client, the send rate, the
+ * latest prediction, the mean latency and the loss. Another process maps the
+ * file with TelemetryReader (or masticc-telemetry) and copies it at any rate:
+ * the seqlock never makes the simulator wait for a reader, the client counters
+ * are fed by trace sinks and the page is only written by a scheduled event.
+ *
+ * The updates are events of their own, so the run needs a Simulator::Stop.
+ * The page stays after the run with the finished flag set.
+ */
+class TelemetryPage : public Object
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    TelemetryPage();
+    ~TelemetryPage() override;
+
+    /**
+     * \brief Publish the state of a client.
+     * \param client the client, added before Start
+     */
+    void AddClient(Ptr<RandomNoiseClient> client);
+
+    /**
+     * \brief Publish the state of every RandomNoiseClient of a container.
+     * \param apps the applications, others than RandomNoiseClient are skipped
+     */
+    void AddClients(const ApplicationContainer& apps);
+
+    /**
+     * \brief Create the page, with one entry per added client, and
+     * schedule the first update.
+     */
+    void Start();
+
+    /**
+     * \brief Publish the final state and cancel the updates.
+     */
+    void Stop();
+
+    /**
+     * \return the file of the page, valid after Start
+     */
+    std::string GetFile() const;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    /// Counters of one client, fed by its trace sources
+    class Probe : public SimpleRefCount<Probe>
+    {
+      public:
+        /**
+         * \param packet packet sent by the client
+         */
+        void Tx(Ptr<const Packet> packet);
+
+        /**
+         * \param packet packet received by the client
+         */
+        void Rx(Ptr<const Packet> packet);
+
+        /**
+         * \param ratio prediction of the client
+         */
+        void Prediction(double ratio);
+
+        /**
+         * \param latency latency sample of the client (s)
+         */
+        void Latency(double latency);
+
+        uint32_t node{0};         //!< Node of the client
+        bool adaptive{false};     //!< A prediction was made
+        uint64_t sent{0};         //!< Packets sent
+        uint64_t received{0};     //!< Packets received
+        uint64_t sentBits{0};     //!< Bits sent
+        uint64_t lastSentBits{0}; //!< Bits sent at the previous update
+        double predictedRatio{0}; //!< Latest prediction
+        double latencySum{0};     //!< Sum of the latency samples since the previous update
+        uint64_t latencyCount{0}; //!< Latency samples since the previous update
+    };
+
+    /**
+     * \brief Write the page and schedule the next update.
+     */
+    void Update();
+
+    /**
+     * \brief Write the state and the client table under the seqlock.
+     * \param finished whether the simulation has stopped
+     */
+    void Publish(bool finished);
+
+    /**
+     * \brief Unmap the page.
+     */
+    void Close();
+
+    std::string m_file;                               //!< File of the page, empty for the default
+    Time m_interval;                                  //!< Time between two updates
+    std::vector<Ptr<Probe>> m_probes;                 //!< Counters of the published clients
+    TelemetryHeader* m_page;                          //!< Shared mapping of the page
+    EventId m_updateEvent;                            //!< Next update
+    Time m_startTime;                                 //!< Simulated time at Start
+    uint64_t m_startEvents;                           //!< Events at Start
+    Time m_lastUpdate;                                //!< Simulated time of the previous update
+    uint64_t m_lastEvents;                            //!< Events at the previous update
+    std::chrono::steady_clock::time_point m_start;    //!< Wall clock at Start
+    std::chrono::steady_clock::time_point m_lastWall; //!< Wall clock at the previous update
+};
+
+/// A consistent copy of a telemetry page
+struct TelemetrySnapshot
+{
+    int32_t pid;                          //!< Process of the simulation
+    TelemetryState state;                 //!< Simulation state
+    std::vector<TelemetryClient> clients; //!< State of the clients
+};
+
+/**
+ * \ingroup randomnoise
+ * \brief Reads the telemetry page of a running simulation.
+ *
+ * The page is mapped read-only, so a reader can never disturb the simulation;
+ * Read() copies it and retries the copy while the writer is updating it.
+ */
+class TelemetryReader
+{
+  public:
+    TelemetryReader();
+    ~TelemetryReader();
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    TelemetryReader(const TelemetryReader&) = delete;
+    TelemetryReader& operator=(const TelemetryReader&) = delete;
+
+    /**
+     * \brief Map a page, unmapping any previous one.
+     * \param file the file of the page
+     * \return false if the file is not an initialized telemetry page
+     */
+    bool Open(const std::string& file);
+
+    /**
+     * \brief Unmap the page.
+     */
+    void Close();
+
+    /**
+     * \brief Copy the page.
+     * \param snapshot the copy
+     * \return false if no consistent copy could be taken, e.g. when the writer
+     *         died in the middle of an update
+     */
+    bool Read(TelemetrySnapshot& snapshot) const;
+
+  private:
+    const TelemetryHeader* m_page; //!< Read-only mapping of the page
+    size_t m_size;                 //!< Size of the mapping
+};
+
+} // namespace ns3
+
+#endif /* TELEMETRY_PAGE_H */
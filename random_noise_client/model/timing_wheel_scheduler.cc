@@ -0,0 +1,235 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/timing_wheel_scheduler.h"
+
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/event-impl.h"
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("TimingWheelScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED(TimingWheelScheduler);
+
+namespace
+{
+
+/**
+ * \brief Heap order of a bucket, earliest event on top.
+ * \param a an event
+ * \param b another event
+ * \return true if a runs after b
+ */
+bool
+Later(const Scheduler::Event& a, const Scheduler::Event& b)
+{
+    return b.key < a.key;
+}
+
+} // namespace
+
+TypeId
+TimingWheelScheduler::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::TimingWheelScheduler")
+            .SetParent<Scheduler>()
+            .SetGroupName("Applications")
+            .AddConstructor<TimingWheelScheduler>()
+            .AddAttribute("Resolution",
+                          "Duration of a slot of the wheel",
+                          TimeValue(MicroSeconds(100)),
+                          MakeTimeAccessor(&TimingWheelScheduler::m_resolutionTime),
+                          MakeTimeChecker(TimeStep(1)))
+            .AddAttribute("Slots",
+                          "Number of slots of the wheel, a power of two",
+                          UintegerValue(4096),
+                          MakeUintegerAccessor(&TimingWheelScheduler::m_slots),
+                          MakeUintegerChecker<uint32_t>(1));
+    return tid;
+}
+
+TimingWheelScheduler::TimingWheelScheduler()
+    : m_slots(0),
+      m_resolution(1),
+      m_mask(0),
+      m_base(0),
+      m_cursor(0),
+      m_wheelCount(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+TimingWheelScheduler::~TimingWheelScheduler()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+TimingWheelScheduler::Setup()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ABORT_MSG_UNLESS((m_slots & (m_slots - 1)) == 0,
+                        "TimingWheelScheduler Slots must be a power of two, not " << m_slots);
+    m_resolution = std::max<int64_t>(m_resolutionTime.GetTimeStep(), 1);
+    m_mask = m_slots - 1;
+    m_wheel.resize(m_slots);
+}
+
+void
+TimingWheelScheduler::Push(const Scheduler::Event& ev, uint64_t slot)
+{
+    Bucket& bucket = m_wheel[slot & m_mask];
+    bucket.push_back(ev);
+    std::push_heap(bucket.begin(), bucket.end(), Later);
+    m_wheelCount++;
+    m_cursor = std::min(m_cursor, slot);
+}
+
+void
+TimingWheelScheduler::Insert(const Scheduler::Event& ev)
+{
+    NS_LOG_FUNCTION(this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+    if (m_wheel.empty())
+    {
+        Setup();
+    }
+    uint64_t slot = ev.key.m_ts / m_resolution;
+    NS_ASSERT_MSG(slot >= m_base, "Event inserted before the last removed one");
+    if (slot - m_base < m_wheel.size())
+    {
+        Push(ev, slot);
+    }
+    else
+    {
+        m_overflow.insert(std::make_pair(ev.key, ev.impl));
+    }
+}
+
+bool
+TimingWheelScheduler::IsEmpty() const
+{
+    return m_wheelCount == 0 && m_overflow.empty();
+}
+
+const TimingWheelScheduler::Bucket*
+TimingWheelScheduler::NextBucket() const
+{
+    if (m_wheelCount == 0)
+    {
+        return nullptr;
+    }
+    // every wheel event is within the horizon, so this stops before wrapping
+    while (m_wheel[m_cursor & m_mask].empty())
+    {
+        m_cursor++;
+    }
+    return &m_wheel[m_cursor & m_mask];
+}
+
+Scheduler::Event
+TimingWheelScheduler::PeekNext() const
+{
+    NS_LOG_FUNCTION(this);
+    const Bucket* bucket = NextBucket();
+    if (bucket)
+    {
+        return bucket->front();
+    }
+    NS_ASSERT(!m_overflow.empty());
+    auto it = m_overflow.begin();
+    Scheduler::Event ev;
+    ev.impl = it->second;
+    ev.key = it->first;
+    return ev;
+}
+
+Scheduler::Event
+TimingWheelScheduler::RemoveNext()
+{
+    NS_LOG_FUNCTION(this);
+    Scheduler::Event ev;
+    if (NextBucket())
+    {
+        Bucket& bucket = m_wheel[m_cursor & m_mask];
+        std::pop_heap(bucket.begin(), bucket.end(), Later);
+        ev = bucket.back();
+        bucket.pop_back();
+        m_wheelCount--;
+    }
+    else
+    {
+        // the wheel ran dry: jump to the first event beyond the horizon
+        NS_ASSERT(!m_overflow.empty());
+        auto it = m_overflow.begin();
+        ev.impl = it->second;
+        ev.key = it->first;
+        m_overflow.erase(it);
+        m_cursor = ev.key.m_ts / m_resolution;
+    }
+    if (m_cursor != m_base)
+    {
+        m_base = m_cursor;
+        Refill();
+    }
+    return ev;
+}
+
+void
+TimingWheelScheduler::Remove(const Scheduler::Event& ev)
+{
+    NS_LOG_FUNCTION(this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+    uint64_t slot = ev.key.m_ts / m_resolution;
+    NS_ASSERT(slot >= m_base);
+    if (slot - m_base >= m_wheel.size())
+    {
+        auto it = m_overflow.find(ev.key);
+        NS_ASSERT(it != m_overflow.end() && it->second == ev.impl);
+        m_overflow.erase(it);
+        return;
+    }
+    Bucket& bucket = m_wheel[slot & m_mask];
+    auto it = std::find_if(bucket.begin(), bucket.end(), [&ev](const Scheduler::Event& e) {
+        return e.key.m_uid == ev.key.m_uid;
+    });
+    NS_ASSERT(it != bucket.end() && it->impl == ev.impl);
+    *it = bucket.back();
+    bucket.pop_back();
+    std::make_heap(bucket.begin(), bucket.end(), Later);
+    m_wheelCount--;
+}
+
+void
+TimingWheelScheduler::Refill()
+{
+    uint64_t horizon = (m_base + m_wheel.size()) * m_resolution;
+    while (!m_overflow.empty() && m_overflow.begin()->first.m_ts < horizon)
+    {
+        auto it = m_overflow.begin();
+        Scheduler::Event ev;
+        ev.impl = it->second;
+        ev.key = it->first;
+        m_overflow.erase(it);
+        Push(ev, ev.key.m_ts / m_resolution);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,106 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TIMING_WHEEL_SCHEDULER_H
+#define TIMING_WHEEL_SCHEDULER_H
+
+#include "ns3/nstime.h"
+#include "ns3/scheduler.h"
+
+#include <map>
+#include <stdint.h>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup randomnoise
+ * \brief Event scheduler for many clients with short-horizon events.
+ *
+ * Time is divided in slots of a fixed resolution and the next Slots slots
+ * form a wheel of buckets. An event within the wheel's horizon goes to the
+ * bucket of its slot, a small binary heap, so Insert and RemoveNext cost a
+ * logarithm of the events in one slot instead of all pending events. Events
+ * further away (application stops, the simulation stop, long idle timers)
+ * wait in an ordered overflow map and move into the wheel as it advances.
+ *
+ * Buckets are vectors that keep their capacity, so a steady workload does
+ * not allocate per event, unlike MapScheduler. The resolution should be
+ * close to the typical gap between consecutive events and the horizon
+ * (Resolution times Slots) longer than most scheduling delays: the
+ * defaults, 100 us and 4096 slots, cover the 10 ms noise intervals, the
+ * sub-millisecond adaptive sends and the link delays of the masticc topology.
+ */
+class TimingWheelScheduler : public Scheduler
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    TimingWheelScheduler();
+    ~TimingWheelScheduler() override;
+
+    // Inherited
+    void Insert(const Scheduler::Event& ev) override;
+    bool IsEmpty() const override;
+    Scheduler::Event PeekNext() const override;
+    Scheduler::Event RemoveNext() override;
+    void Remove(const Scheduler::Event& ev) override;
+
+  private:
+    /// Events of one slot, a min-heap on the event key
+    typedef std::vector<Scheduler::Event> Bucket;
+
+    /**
+     * \brief Allocate the wheel from the attributes, on the first Insert.
+     */
+    void Setup();
+
+    /**
+     * \param ev an event inside the wheel's horizon
+     * \param slot its slot
+     */
+    void Push(const Scheduler::Event& ev, uint64_t slot);
+
+    /**
+     * \brief Move the overflow events that entered the horizon into the wheel.
+     */
+    void Refill();
+
+    /**
+     * \return the first non-empty bucket, with m_cursor on its slot,
+     *         or nullptr if the wheel is empty
+     */
+    const Bucket* NextBucket() const;
+
+    Time m_resolutionTime; //!< Duration of a slot
+    uint32_t m_slots;      //!< Number of buckets, a power of two
+
+    uint64_t m_resolution;                                //!< Duration of a slot (time steps)
+    uint64_t m_mask;                                      //!< Bucket index mask
+    std::vector<Bucket> m_wheel;                          //!< One bucket per slot
+    uint64_t m_base;                                      //!< Slot of the last removed event
+    mutable uint64_t m_cursor;                            //!< No event before this slot
+    uint64_t m_wheelCount;                                //!< Events in the wheel
+    std::map<Scheduler::EventKey, EventImpl*> m_overflow; //!< Events beyond the horizon
+};
+
+} // namespace ns3
+
+#endif /* TIMING_WHEEL_SCHEDULER_H */
@@ -0,0 +1,321 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Benchmarks of the random_noise_client hot paths.
+//
+// Runs fixed-seed scenarios on the masticc topology and writes the results
+// as JSON, so that regressions in Send, HandleRead or the end-to-end event
+// rate show up in a diff of two result files:
+//
+//   send        noise-only clients at 1, 100 and 1000 instances
+//   handleread  one adaptive client per prediction backend, cost per echo
+//   e2e         the network_topology scenario with nClients 2, 64 and 1024
+//               and bottleneck rates of 1, 10 and 100 Mbps
+//   scheduler   schedulerClients noise clients on a 100 Mbps bottleneck, once
+//               per event scheduler; the fastest one is reported
+//
+//   ./ns3 run "masticc-benchmark --cases=send,e2e --output=bench.json"
+//   ./ns3 run "masticc-benchmark --cases=scheduler --schedulerClients=1000"
+//
+// Only Simulator::Run() is timed; topology setup is reported separately.
+
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+#include "ns3/random_noise_client-module.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("MasticcBenchmark");
+
+namespace
+{
+
+/// One benchmark scenario
+struct Scenario
+{
+    std::string name;                //!< Case name
+    uint32_t nClients{2};            //!< Clients connected to R1
+    uint32_t nNoise{1};              //!< Noise clients, on the first spokes
+    bool echoProbe{true};            //!< UdpEchoClient on the spoke after the noise clients
+    bool adaptive{false};            //!< Adaptive RandomNoiseClient instead of the probe
+    std::string predictor{"Native"}; //!< Backend of the adaptive client
+    std::string scheduler{"Map"};    //!< Event scheduler, see SchedulerHelper
+    uint32_t bottleneckRate{1};      //!< Mbps
+    double duration{2};              //!< Simulated seconds
+};
+
+/// Measurements of one scenario
+struct Result
+{
+    double setupSeconds{0}; //!< Wall clock spent building the scenario
+    double runSeconds{0};   //!< Wall clock spent in Simulator::Run()
+    uint64_t events{0};     //!< Events executed
+    uint64_t tx{0};         //!< Packets sent by RandomNoiseClients
+    uint64_t rx{0};         //!< Echoes received by RandomNoiseClients
+    double clientBytes{0};  //!< Mean memory held by a RandomNoiseClient after the run
+};
+
+uint64_t g_tx = 0; //!< Packets sent in the current scenario
+uint64_t g_rx = 0; //!< Echoes received in the current scenario
+
+void
+CountTx(Ptr<const Packet>)
+{
+    g_tx++;
+}
+
+void
+CountRx(Ptr<const Packet>)
+{
+    g_rx++;
+}
+
+double
+Since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+Result
+Run(const Scenario& scenario, const std::string& modelFile)
+{
+    SchedulerHelper::Set(scenario.scheduler);
+    RngSeedManager::SetSeed(1);
+    RngSeedManager::SetRun(1);
+    g_tx = 0;
+    g_rx = 0;
+    Result result;
+    auto start = std::chrono::steady_clock::now();
+
+    MasticcTopologyHelper topology;
+    uint32_t nSpokes = scenario.nNoise + (scenario.echoProbe || scenario.adaptive ? 1 : 0);
+    topology.SetNClients(std::max(scenario.nClients, nSpokes));
+    topology.SetBottleneckLink(DataRate(scenario.bottleneckRate * 1000000), MilliSeconds(10));
+    topology.Install();
+    Time stop = Seconds(scenario.duration);
+
+    UdpEchoServerHelper echoServer(9);
+    echoServer.Install(topology.GetServer()).Stop(stop);
+
+    ApplicationContainer clients;
+    RandomNoiseClientHelper noiseClient(topology.GetServerAddress(), 9);
+    noiseClient.SetAttribute("IntervalMean", DoubleValue(0.01));
+    noiseClient.SetAttribute("PacketSizeMean", DoubleValue(1000));
+    noiseClient.SetAttribute("PacketSizeVariance", DoubleValue(300 * 300));
+    for (uint32_t i = 0; i < scenario.nNoise; i++)
+    {
+        clients.Add(noiseClient.Install(topology.GetClient(i)));
+    }
+    if (scenario.adaptive)
+    {
+        RandomNoiseClientHelper adaptiveClient(topology.GetServerAddress(), 9);
+        adaptiveClient.SetAttribute("IntervalMean", DoubleValue(0));
+        adaptiveClient.SetAttribute("Predictor", StringValue(scenario.predictor));
+        adaptiveClient.SetAttribute("ModelFile", StringValue(modelFile));
+        clients.Add(adaptiveClient.Install(topology.GetClient(scenario.nNoise)));
+    }
+    else if (scenario.echoProbe)
+    {
+        UdpEchoClientHelper echoClient(topology.GetServerAddress(), 9);
+        echoClient.SetAttribute("MaxPackets", UintegerValue(0));
+        echoClient.SetAttribute("Interval", TimeValue(Seconds(0.1)));
+        echoClient.SetAttribute("PacketSize", UintegerValue(1024));
+        echoClient.Install(topology.GetClient(scenario.nNoise)).Stop(stop);
+    }
+    clients.Stop(stop);
+    for (uint32_t i = 0; i < clients.GetN(); i++)
+    {
+        clients.Get(i)->TraceConnectWithoutContext("Tx", MakeCallback(&CountTx));
+        clients.Get(i)->TraceConnectWithoutContext("Rx", MakeCallback(&CountRx));
+    }
+    result.setupSeconds = Since(start);
+
+    Simulator::Stop(stop);
+    start = std::chrono::steady_clock::now();
+    Simulator::Run();
+    result.runSeconds = Since(start);
+    result.events = Simulator::GetEventCount();
+    result.tx = g_tx;
+    result.rx = g_rx;
+    for (uint32_t i = 0; i < clients.GetN(); i++)
+    {
+        Ptr<RandomNoiseClient> client = DynamicCast<RandomNoiseClient>(clients.Get(i));
+        result.clientBytes += client->GetMemoryUsage().GetTotal() / double(clients.GetN());
+    }
+    Simulator::Destroy();
+    return result;
+}
+
+void
+WriteJson(std::ostream& os, const Scenario& scenario, const Result& result)
+{
+    os << "    {\"case\": \"" << scenario.name << "\", \"nClients\": " << scenario.nClients
+       << ", \"noiseClients\": " << scenario.nNoise << ", \"predictor\": \""
+       << (scenario.adaptive ? scenario.predictor : "none") << "\", \"scheduler\": \""
+       << scenario.scheduler
+       << "\", \"bottleneckMbps\": " << scenario.bottleneckRate
+       << ", \"simulatedSeconds\": " << scenario.duration
+       << ", \"setupSeconds\": " << result.setupSeconds
+       << ", \"runSeconds\": " << result.runSeconds << ", \"events\": " << result.events
+       << ", \"eventsPerSecond\": " << result.events / result.runSeconds
+       << ", \"simulatedPerWallSecond\": " << scenario.duration / result.runSeconds
+       << ", \"packetsSent\": " << result.tx << ", \"sendsPerSecond\": "
+       << result.tx / result.runSeconds << ", \"echoesReceived\": " << result.rx
+       << ", \"nsPerEcho\": " << (result.rx > 0 ? result.runSeconds * 1e9 / result.rx : 0)
+       << ", \"bytesPerClient\": " << result.clientBytes
+       << "}";
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    std::string cases = "send,handleread,e2e";
+    double duration = 2;
+    bool python = false;
+    std::string modelFile = "masticc/savedModel.txt";
+    std::string output = "benchmark.json";
+    std::string scheduler = "Map";
+    std::string schedulers = "Map,Heap,Calendar,PriorityQueue,TimingWheel";
+    uint32_t schedulerClients = 1024;
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("cases", "Comma separated cases: send, handleread, e2e, scheduler", cases);
+    cmd.AddValue("duration", "Simulated seconds per scenario", duration);
+    cmd.AddValue("python", "Also benchmark the Python predictor (slow)", python);
+    cmd.AddValue("modelFile", "Model of the Native predictor", modelFile);
+    cmd.AddValue("output", "JSON result file", output);
+    cmd.AddValue("scheduler", "Event scheduler of the send, handleread and e2e cases", scheduler);
+    cmd.AddValue("schedulers", "Schedulers compared by the scheduler case", schedulers);
+    cmd.AddValue("schedulerClients", "Number of clients of the scheduler case", schedulerClients);
+    cmd.Parse(argc, argv);
+
+    auto enabled = [&cases](const std::string& name) {
+        return ("," + cases + ",").find("," + name + ",") != std::string::npos;
+    };
+
+    std::vector<Scenario> scenarios;
+    if (enabled("send"))
+    {
+        for (uint32_t n : {1, 100, 1000})
+        {
+            Scenario scenario;
+            scenario.name = "send";
+            scenario.nClients = n;
+            scenario.nNoise = n;
+            scenario.echoProbe = false;
+            scenarios.push_back(scenario);
+        }
+    }
+    if (enabled("handleread"))
+    {
+        std::vector<std::string> predictors{"Native"};
+        if (python)
+        {
+            predictors.push_back("Python");
+        }
+        for (const std::string& predictor : predictors)
+        {
+            Scenario scenario;
+            scenario.name = "handleread";
+            scenario.nNoise = 0;
+            scenario.adaptive = true;
+            scenario.predictor = predictor;
+            scenarios.push_back(scenario);
+        }
+    }
+    if (enabled("e2e"))
+    {
+        for (uint32_t n : {2, 64, 1024})
+        {
+            for (uint32_t rate : {1, 10, 100})
+            {
+                Scenario scenario;
+                scenario.name = "e2e";
+                scenario.nClients = n;
+                scenario.bottleneckRate = rate;
+                scenarios.push_back(scenario);
+            }
+        }
+    }
+    for (Scenario& scenario : scenarios)
+    {
+        scenario.scheduler = scheduler;
+    }
+    if (enabled("scheduler"))
+    {
+        std::istringstream list(schedulers);
+        std::string name;
+        while (std::getline(list, name, ','))
+        {
+            SchedulerHelper::Lookup(name);
+            Scenario scenario;
+            scenario.name = "scheduler";
+            scenario.nClients = schedulerClients;
+            scenario.nNoise = schedulerClients > 1 ? schedulerClients - 1 : 0;
+            scenario.bottleneckRate = 100;
+            scenario.scheduler = name;
+            scenarios.push_back(scenario);
+        }
+    }
+    NS_ABORT_MSG_IF(scenarios.empty(), "No known case in " << cases);
+
+    std::ostringstream json;
+    json << "{\n  \"benchmark\": \"masticc\",\n  \"results\": [\n";
+    std::string fastest;
+    double fastestSeconds = 0;
+    for (uint32_t i = 0; i < scenarios.size(); i++)
+    {
+        Scenario& scenario = scenarios[i];
+        scenario.duration = duration;
+        std::clog << "running " << scenario.name << " nClients=" << scenario.nClients
+                  << " bottleneck=" << scenario.bottleneckRate << "Mbps"
+                  << " scheduler=" << scenario.scheduler << std::endl;
+        Result result = Run(scenario, modelFile);
+        WriteJson(json, scenario, result);
+        json << (i + 1 < scenarios.size() ? ",\n" : "\n");
+        // every scheduler executes the same events, so the run time decides
+        if (scenario.name == "scheduler" && (fastest.empty() || result.runSeconds < fastestSeconds))
+        {
+            fastest = scenario.scheduler;
+            fastestSeconds = result.runSeconds;
+        }
+    }
+    json << "  ]";
+    if (!fastest.empty())
+    {
+        json << ",\n  \"fastestScheduler\": {\"nClients\": " << schedulerClients
+             << ", \"scheduler\": \"" << fastest << "\", \"runSeconds\": " << fastestSeconds
+             << "}";
+        std::clog << "fastest scheduler for " << schedulerClients << " clients: " << fastest
+                  << std::endl;
+    }
+    json << "\n}\n";
+
+    std::ofstream file(output);
+    if (!file.is_open())
+    {
+        NS_FATAL_ERROR("Could not create " << output);
+    }
+    file << json.str();
+    std::cout << json.str();
+    return 0;
+}
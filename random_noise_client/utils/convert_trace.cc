@@ -0,0 +1,183 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Converts a capture or a CSV into a noise trace for the TraceFile attribute
+// of RandomNoiseClient.
+//
+// Captures (pcap or header summary) keep the time and the UDP payload of
+// every IPv4 packet. CSV rows are "time,size" with the time in seconds and
+// the UDP payload in bytes; a header line is skipped.
+//
+//   ./ns3 run "masticc-convert-trace capture.pcap noise.mnt"
+//   ./ns3 run "masticc-convert-trace load.csv noise.mnt"
+
+#include "ns3/capture_stream.h"
+#include "ns3/command-line.h"
+#include "ns3/log.h"
+#include "ns3/noise_trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("MasticcConvertTrace");
+
+namespace
+{
+
+/**
+ * \brief Turns absolute packet times into the intervals of a noise trace.
+ *
+ * Intervals are taken between rounded absolute times, so rounding to
+ * microseconds does not accumulate over the trace.
+ */
+class TraceBuilder
+{
+  public:
+    /**
+     * \param writer the trace to append to
+     */
+    TraceBuilder(NoiseTraceWriter& writer)
+        : m_writer(writer)
+    {
+    }
+
+    /**
+     * \param time packet time (s)
+     * \param size UDP payload (bytes)
+     */
+    void Add(double time, uint32_t size)
+    {
+        int64_t us = std::llround(time * 1e6);
+        int64_t delta = m_first ? 0 : us - m_last;
+        if (delta < 0)
+        {
+            m_reordered++;
+            delta = 0;
+        }
+        if (delta > std::numeric_limits<uint32_t>::max())
+        {
+            m_clamped++;
+            delta = std::numeric_limits<uint32_t>::max();
+        }
+        m_writer.Write(delta, size);
+        m_last = m_first ? us : std::max(us, m_last);
+        m_first = false;
+    }
+
+    /**
+     * \return packets earlier than the one before them, sent back to back
+     */
+    uint64_t GetReordered() const
+    {
+        return m_reordered;
+    }
+
+    /**
+     * \return intervals longer than a record can hold
+     */
+    uint64_t GetClamped() const
+    {
+        return m_clamped;
+    }
+
+  private:
+    NoiseTraceWriter& m_writer; //!< The trace
+    int64_t m_last{0};          //!< Latest packet time (us)
+    bool m_first{true};         //!< No packet added yet
+    uint64_t m_reordered{0};    //!< Negative intervals replaced by 0
+    uint64_t m_clamped{0};      //!< Intervals clamped to the record range
+};
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    std::string input;
+    std::string output = "noise.mnt";
+    uint32_t headerBytes = 28; // IPv4 and UDP
+    CommandLine cmd(__FILE__);
+    cmd.AddNonOption("input", "Capture (pcap or header summary) or CSV to convert", input);
+    cmd.AddNonOption("output", "Noise trace to write", output);
+    cmd.AddValue("headerBytes", "Bytes subtracted from captured IPv4 lengths", headerBytes);
+    cmd.Parse(argc, argv);
+
+    NoiseTraceWriter writer(output);
+    TraceBuilder builder(writer);
+
+    CaptureStream capture;
+    if (capture.Open(input))
+    {
+        CapturedPacket packet;
+        while (capture.Next(packet))
+        {
+            builder.Add(packet.time, packet.size > headerBytes ? packet.size - headerBytes : 0);
+        }
+    }
+    else
+    {
+        std::ifstream csv(input);
+        if (!csv.is_open())
+        {
+            std::cerr << "Could not read " << input << std::endl;
+            return 1;
+        }
+        std::string line;
+        uint64_t lineNumber = 0;
+        while (std::getline(csv, line))
+        {
+            lineNumber++;
+            std::istringstream row(line);
+            double time;
+            double size;
+            char comma;
+            if (!(row >> time >> comma >> size) || comma != ',' || size < 0)
+            {
+                if (lineNumber > 1)
+                {
+                    std::cerr << input << ":" << lineNumber << ": not a time,size row" << std::endl;
+                    return 1;
+                }
+                continue; // header
+            }
+            builder.Add(time, size);
+        }
+    }
+    writer.Close();
+
+    if (writer.GetCount() == 0)
+    {
+        std::cerr << "No packets found in " << input << std::endl;
+        return 1;
+    }
+    std::cout << "Wrote " << writer.GetCount() << " packets to " << output << std::endl;
+    if (builder.GetReordered() > 0)
+    {
+        std::cout << builder.GetReordered() << " out of order packets are sent back to back"
+                  << std::endl;
+    }
+    if (builder.GetClamped() > 0)
+    {
+        std::cout << builder.GetClamped() << " intervals were clamped to "
+                  << std::numeric_limits<uint32_t>::max() << " us" << std::endl;
+    }
+    return 0;
+}
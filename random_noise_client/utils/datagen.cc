@@ -0,0 +1,317 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Training data generation without Python, pcaps or process spawns.
+//
+// Runs the generate_training_data.py sweep in one process: every scenario is
+// built on the masticc topology, simulated, and destroyed before the next
+// one. The client and server link packets are fed to LatencyFeatureExtractor
+// from the PromiscSniffer traces while the simulation runs, and the rows are
+// appended to the dataset directly, trimmed like masticc-process-pcap does.
+//
+// Sweeps are comma separated values or inclusive start:stop:step ranges;
+// noise rates are fractions of the bottleneck rate.
+//
+//   ./ns3 run "masticc-datagen --bottleneckRates=5:50:5 --noiseRatios=0.1:1.1:0.2
+//              --noiseSizes=600,850,1100 --output=masticc/training_data/latency_data.csv"
+
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/random_noise_client-module.h"
+
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("MasticcDatagen");
+
+namespace
+{
+
+/**
+ * \brief Parse a sweep specification.
+ * \param spec comma separated values or start:stop:step ranges
+ * \return the values, in order
+ */
+std::vector<double>
+ParseSweep(const std::string& spec)
+{
+    std::vector<double> values;
+    std::istringstream list(spec);
+    std::string item;
+    while (std::getline(list, item, ','))
+    {
+        double start;
+        double stop;
+        double step;
+        char colon1;
+        char colon2;
+        std::istringstream range(item);
+        if (item.find(':') == std::string::npos)
+        {
+            values.push_back(std::stod(item));
+        }
+        else if ((range >> start >> colon1 >> stop >> colon2 >> step) && colon1 == ':' &&
+                 colon2 == ':' && step > 0)
+        {
+            // stop is inclusive, up to rounding of the step
+            for (uint32_t i = 0; start + i * step <= stop + step * 1e-6; i++)
+            {
+                values.push_back(start + i * step);
+            }
+        }
+        else
+        {
+            NS_FATAL_ERROR("Invalid sweep " << item << ", expected start:stop:step");
+        }
+    }
+    NS_ABORT_MSG_IF(values.empty(), "Empty sweep " << spec);
+    return values;
+}
+
+/**
+ * \brief Online replacement of the client and router1 captures.
+ *
+ * Receives the packets of the adaptive client's device and of the R2 to
+ * server link in simulation order and writes the finished feature rows.
+ */
+class OnlineCapture
+{
+  public:
+    /**
+     * \param bottleneckRate capacity of the bottleneck link (bit/s)
+     * \param lossHorizon time to wait for an echo before a packet is lost (s)
+     * \param server address whose packets are returning echoes
+     * \param csv dataset the rows are appended to
+     * \param trim rows dropped at the start and at the end of the scenario
+     */
+    OnlineCapture(double bottleneckRate,
+                  double lossHorizon,
+                  Ipv4Address server,
+                  std::ostream& csv,
+                  uint32_t trim)
+        : m_extractor(bottleneckRate, lossHorizon),
+          m_server(server),
+          m_csv(csv),
+          m_trim(trim)
+    {
+    }
+
+    /**
+     * \param device the client device, captured like client.pcap
+     */
+    void SetClientDevice(Ptr<NetDevice> device)
+    {
+        device->TraceConnectWithoutContext("PromiscSniffer",
+                                           MakeCallback(&OnlineCapture::ClientPacket, this));
+    }
+
+    /**
+     * \param device the server link device, captured like router1.pcap
+     */
+    void SetRouterDevice(Ptr<NetDevice> device)
+    {
+        device->TraceConnectWithoutContext("PromiscSniffer",
+                                           MakeCallback(&OnlineCapture::RouterPacket, this));
+    }
+
+    /**
+     * \brief Flush the remaining rows, dropping the trimmed tail.
+     * \return the number of rows written
+     */
+    uint64_t Finish()
+    {
+        m_extractor.Finish();
+        Drain();
+        return m_nRows > 2 * m_trim ? m_nRows - 2 * m_trim : 0;
+    }
+
+  private:
+    /**
+     * \param packet a captured point-to-point frame
+     * \param ip filled in with its IPv4 header
+     * \return false if the frame does not carry IPv4
+     */
+    static bool Parse(Ptr<const Packet> packet, Ipv4Header& ip)
+    {
+        Ptr<Packet> copy = packet->Copy();
+        PppHeader ppp;
+        return copy->RemoveHeader(ppp) && ppp.GetProtocol() == 0x0021 && copy->PeekHeader(ip);
+    }
+
+    void ClientPacket(Ptr<const Packet> packet)
+    {
+        Ipv4Header ip;
+        if (Parse(packet, ip) && ip.GetProtocol() == UdpL4Protocol::PROT_NUMBER &&
+            ip.GetFragmentOffset() == 0)
+        {
+            m_extractor.AddClientPacket(Simulator::Now().GetSeconds(), ip.GetIdentification());
+            Drain();
+        }
+    }
+
+    void RouterPacket(Ptr<const Packet> packet)
+    {
+        Ipv4Header ip;
+        if (Parse(packet, ip) && ip.GetSource() != m_server) // skip returning echoes
+        {
+            m_extractor.AddBottleneckPacket(Simulator::Now().GetSeconds(),
+                                            ip.GetSerializedSize() + ip.GetPayloadSize());
+        }
+    }
+
+    void Drain()
+    {
+        LatencyFeatureRow row;
+        while (m_extractor.PopRow(row))
+        {
+            if (m_nRows++ < m_trim)
+            {
+                continue;
+            }
+            m_tail.push_back(row);
+            if (m_tail.size() > m_trim)
+            {
+                m_tail.front().WriteCsv(m_csv);
+                m_tail.pop_front();
+            }
+        }
+    }
+
+    LatencyFeatureExtractor m_extractor;  //!< Feature computation
+    Ipv4Address m_server;                 //!< Source of the echoes
+    std::ostream& m_csv;                  //!< Dataset
+    uint32_t m_trim;                      //!< Rows dropped at both ends
+    uint64_t m_nRows{0};                  //!< Rows produced so far
+    std::deque<LatencyFeatureRow> m_tail; //!< Rows held back until the end is known
+};
+
+/// One point of the sweep
+struct Scenario
+{
+    double bottleneckRate; //!< Mbps
+    double noiseRate;      //!< Mbps
+    double noiseSize;      //!< Mean noise packet size (bytes)
+};
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    std::string bottleneckRates = "5:50:5"; // Mbps
+    std::string noiseRatios = "0.1:1.1:0.2";
+    std::string noiseSizes = "600:1100:250"; // bytes
+    uint32_t bottleneckDelay = 0;            // ms
+    double duration = 10;                    // s
+    double lossHorizon = 1.0;                // s
+    uint32_t trim = 4;
+    std::string output = "training_data/latency_data.csv";
+    std::string scheduler = "Map";
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("bottleneckRates", "Bottleneck rates of the sweep (Mbps)", bottleneckRates);
+    cmd.AddValue("noiseRatios", "Noise rates of the sweep, as fractions of the bottleneck rate", noiseRatios);
+    cmd.AddValue("noiseSizes", "Mean noise packet sizes of the sweep (bytes)", noiseSizes);
+    cmd.AddValue("bottleneckDelay", "Delay of the bottleneck link (ms)", bottleneckDelay);
+    cmd.AddValue("duration", "Time the applications run in every scenario (s)", duration);
+    cmd.AddValue("lossHorizon", "Time to wait for an echo before a packet is lost (s)", lossHorizon);
+    cmd.AddValue("trim", "Rows dropped at the start and the end of every scenario", trim);
+    cmd.AddValue("output", "CSV file the rows are appended to", output);
+    cmd.AddValue("scheduler", "Event scheduler: Map, Heap, Calendar, PriorityQueue or TimingWheel", scheduler);
+    cmd.Parse(argc, argv);
+    SchedulerHelper::Set(scheduler);
+
+    std::vector<Scenario> scenarios;
+    for (double rate : ParseSweep(bottleneckRates))
+    {
+        for (double ratio : ParseSweep(noiseRatios))
+        {
+            for (double size : ParseSweep(noiseSizes))
+            {
+                scenarios.push_back({rate, ratio * rate, size});
+            }
+        }
+    }
+
+    bool exists = std::ifstream(output).good();
+    std::ofstream csv(output, std::ios::app);
+    if (!csv.is_open())
+    {
+        NS_FATAL_ERROR("Could not open " << output);
+    }
+    if (!exists)
+    {
+        LatencyFeatureRow::WriteCsvHeader(csv);
+    }
+
+    uint64_t totalRows = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < scenarios.size(); i++)
+    {
+        const Scenario& scenario = scenarios[i];
+        std::clog << "[" << i + 1 << "/" << scenarios.size() << "] bottleneck "
+                  << scenario.bottleneckRate << " Mbps, noise " << scenario.noiseRate << " Mbps "
+                  << scenario.noiseSize << " bytes" << std::flush;
+
+        MasticcTopologyHelper topology;
+        topology.SetBottleneckLink(DataRate(scenario.bottleneckRate * 1e6),
+                                   MilliSeconds(bottleneckDelay));
+        topology.Install();
+        Time stop = Seconds(duration);
+
+        UdpEchoServerHelper echoServer(9);
+        echoServer.Install(topology.GetServer()).Stop(stop);
+
+        RandomNoiseClientHelper noiseClient(topology.GetServerAddress(), 9);
+        noiseClient.SetAttribute("TargetRate", DataRateValue(DataRate(scenario.noiseRate * 1e6)));
+        noiseClient.SetAttribute("PacketSizeMean", DoubleValue(scenario.noiseSize));
+        double stdev = scenario.noiseSize * .3;
+        noiseClient.SetAttribute("PacketSizeVariance", DoubleValue(stdev * stdev));
+        noiseClient.Install(topology.GetClient(0)).Stop(stop);
+
+        UdpEchoClientHelper echoClient(topology.GetServerAddress(), 9);
+        echoClient.SetAttribute("MaxPackets", UintegerValue(0));
+        echoClient.SetAttribute("Interval", TimeValue(Seconds(0.1)));
+        echoClient.SetAttribute("PacketSize", UintegerValue(1024));
+        echoClient.Install(topology.GetClient(1)).Stop(stop);
+
+        OnlineCapture capture(scenario.bottleneckRate * 1e6,
+                              lossHorizon,
+                              topology.GetServerAddress(),
+                              csv,
+                              trim);
+        capture.SetClientDevice(topology.GetClientDevice(1));
+        capture.SetRouterDevice(topology.GetServerLinkDevice());
+
+        Simulator::Stop(stop + Seconds(5));
+        Simulator::Run();
+        uint64_t rows = capture.Finish();
+        Simulator::Destroy();
+
+        totalRows += rows;
+        std::clog << ": " << rows << " rows" << std::endl;
+    }
+    double wall =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Appended " << totalRows << " rows from " << scenarios.size() << " scenarios to "
+              << output << " in " << wall << " s" << std::endl;
+    return 0;
+}
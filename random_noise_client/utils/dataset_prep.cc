@@ -0,0 +1,416 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Prepares latency_data.csv for training in one streaming pass: the rows are
+// cut into buckets of consecutive rows (the buckets of splitData in
+// trainLSTM.py), every bucket goes to the train, validation or test split,
+// and each split is written as contiguous float32 tensors. The feature and
+// target scaler statistics are computed on the training split only and saved
+// in the format LstmModel and exportLSTM.py read.
+//
+// A bucket's split only depends on the seed and the bucket index, so the
+// rows appended by later sweeps do not move the buckets already assigned.
+//
+//   ./ns3 run "masticc-dataset-prep --input=masticc/training_data/latency_data.csv
+//              --output=masticc/training_data/prepared --bucketSize=100 --seed=1"
+//
+// Output directory:
+//   dataset.txt          columns, seed, bucket size and rows/buckets per split
+//   <split>_x.f32        features, rows x features, row-major
+//   <split>_y.f32        targets, one per row
+//   scaler.txt           feature mean and scale, target range of the training split
+
+#include "ns3/core-module.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+using namespace ns3;
+
+namespace
+{
+
+/// Splits of the dataset
+enum SplitKind
+{
+    SPLIT_TRAIN,
+    SPLIT_VALIDATION,
+    SPLIT_TEST,
+    SPLIT_COUNT,
+};
+
+/// File name prefixes of the splits
+const char* const SPLIT_NAMES[SPLIT_COUNT] = {"train", "validation", "test"};
+
+/// Rows of one bucket
+struct Bucket
+{
+    std::vector<float> features; //!< rows x features
+    std::vector<float> targets;  //!< One per row
+};
+
+/**
+ * \brief SplitMix64 finalizer, the portable hash of a bucket index.
+ * \param x the value to mix
+ * \return the mixed value
+ */
+uint64_t
+Mix(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * \brief Draw the split of a bucket.
+ * \param seed the split seed
+ * \param index the bucket index
+ * \param validation fraction of the validation buckets
+ * \param test fraction of the test buckets
+ * \return the split
+ */
+SplitKind
+Classify(uint64_t seed, uint64_t index, double validation, double test)
+{
+    double u = (Mix(Mix(seed) ^ index) >> 11) * 0x1.0p-53;
+    if (u < test)
+    {
+        return SPLIT_TEST;
+    }
+    return u < test + validation ? SPLIT_VALIDATION : SPLIT_TRAIN;
+}
+
+/**
+ * \brief One split being written.
+ */
+class SplitWriter
+{
+  public:
+    /**
+     * \param directory output directory
+     * \param name split name
+     */
+    SplitWriter(const std::string& directory, const std::string& name)
+        : m_x(directory + "/" + name + "_x.f32", std::ios::binary),
+          m_y(directory + "/" + name + "_y.f32", std::ios::binary)
+    {
+        if (!m_x.is_open() || !m_y.is_open())
+        {
+            NS_FATAL_ERROR("Could not write the " << name << " split to " << directory);
+        }
+    }
+
+    /**
+     * \param bucket the rows to append
+     */
+    void Write(const Bucket& bucket)
+    {
+        m_x.write(reinterpret_cast<const char*>(bucket.features.data()),
+                  bucket.features.size() * sizeof(float));
+        m_y.write(reinterpret_cast<const char*>(bucket.targets.data()),
+                  bucket.targets.size() * sizeof(float));
+        rows += bucket.targets.size();
+        buckets++;
+    }
+
+    /**
+     * \return true if every row was written
+     */
+    bool Close()
+    {
+        m_x.close();
+        m_y.close();
+        return !m_x.fail() && !m_y.fail();
+    }
+
+    uint64_t rows{0};    //!< Rows written
+    uint64_t buckets{0}; //!< Buckets written
+
+  private:
+    std::ofstream m_x; //!< Features
+    std::ofstream m_y; //!< Targets
+};
+
+/**
+ * \brief StandardScaler and MinMaxScaler statistics, accumulated row by row
+ * with Welford's update.
+ */
+class ScalerStats
+{
+  public:
+    /**
+     * \param nFeatures features per row
+     */
+    explicit ScalerStats(uint32_t nFeatures)
+        : m_mean(nFeatures, 0),
+          m_m2(nFeatures, 0)
+    {
+    }
+
+    /**
+     * \param bucket rows of the training split
+     */
+    void Add(const Bucket& bucket)
+    {
+        uint32_t nFeatures = m_mean.size();
+        for (uint32_t r = 0; r < bucket.targets.size(); r++)
+        {
+            m_count++;
+            const float* row = &bucket.features[r * nFeatures];
+            for (uint32_t f = 0; f < nFeatures; f++)
+            {
+                double delta = row[f] - m_mean[f];
+                m_mean[f] += delta / m_count;
+                m_m2[f] += delta * (row[f] - m_mean[f]);
+            }
+            m_targetMin = std::min<double>(m_targetMin, bucket.targets[r]);
+            m_targetMax = std::max<double>(m_targetMax, bucket.targets[r]);
+        }
+    }
+
+    /**
+     * \brief Write the sections LstmModel reads.
+     * \param os the scaler file
+     */
+    void Write(std::ostream& os) const
+    {
+        os.precision(17);
+        os << "scaler " << m_mean.size() << "\n";
+        os << "feature_mean " << m_mean.size() << "\n";
+        WriteValues(os, m_mean);
+        std::vector<double> scale(m_mean.size());
+        for (uint32_t f = 0; f < scale.size(); f++)
+        {
+            // population standard deviation, like StandardScaler
+            scale[f] = std::sqrt(m_m2[f] / m_count);
+        }
+        os << "feature_scale " << scale.size() << "\n";
+        WriteValues(os, scale);
+        os << "target_range 2\n" << m_targetMin << " " << m_targetMax << "\n";
+    }
+
+  private:
+    /**
+     * \param os the stream
+     * \param values space separated on one line
+     */
+    static void WriteValues(std::ostream& os, const std::vector<double>& values)
+    {
+        for (uint32_t i = 0; i < values.size(); i++)
+        {
+            os << (i ? " " : "") << values[i];
+        }
+        os << "\n";
+    }
+
+    uint64_t m_count{0};                                          //!< Rows added
+    std::vector<double> m_mean;                                   //!< Running feature means
+    std::vector<double> m_m2;                                     //!< Sums of squared deviations
+    double m_targetMin{std::numeric_limits<double>::infinity()};  //!< Smallest target
+    double m_targetMax{-std::numeric_limits<double>::infinity()}; //!< Largest target
+};
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    std::string input = "training_data/latency_data.csv";
+    std::string output = "training_data/prepared";
+    uint32_t bucketSize = 100;
+    double validationFraction = 0.1;
+    double testFraction = 0.1;
+    uint64_t seed = 1;
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("input", "Dataset written by masticc-process-pcap or masticc-datagen", input);
+    cmd.AddValue("output", "Directory of the tensors and the scaler", output);
+    cmd.AddValue("bucketSize", "Consecutive rows kept together in one split", bucketSize);
+    cmd.AddValue("validationFraction", "Fraction of the buckets in the validation split", validationFraction);
+    cmd.AddValue("testFraction", "Fraction of the buckets in the test split", testFraction);
+    cmd.AddValue("seed", "Seed of the bucket assignment", seed);
+    cmd.Parse(argc, argv);
+    NS_ABORT_MSG_IF(bucketSize == 0, "--bucketSize must be positive");
+    NS_ABORT_MSG_IF(validationFraction < 0 || testFraction < 0 ||
+                        validationFraction + testFraction >= 1,
+                    "The validation and test fractions must leave buckets for training");
+
+    std::ifstream csv(input);
+    if (!csv.is_open())
+    {
+        std::cerr << "Could not read " << input << std::endl;
+        return 1;
+    }
+    // ts, the features, the target last
+    std::string header;
+    std::getline(csv, header);
+    std::vector<std::string> columns;
+    std::istringstream names(header);
+    for (std::string name; std::getline(names, name, ',');)
+    {
+        columns.push_back(name);
+    }
+    if (columns.size() < 3)
+    {
+        std::cerr << input << ": expected ts, features and a target column" << std::endl;
+        return 1;
+    }
+    uint32_t nFeatures = columns.size() - 2;
+
+    SystemPath::MakeDirectories(output);
+    std::vector<SplitWriter> splits;
+    splits.reserve(SPLIT_COUNT);
+    for (uint32_t s = 0; s < SPLIT_COUNT; s++)
+    {
+        splits.emplace_back(output, SPLIT_NAMES[s]);
+    }
+    ScalerStats stats(nFeatures);
+
+    // the latest training buckets are held back, to give the test or the
+    // validation split a bucket at the end if the draws left it empty
+    std::deque<Bucket> held;
+    auto writeTrain = [&](const Bucket& bucket) {
+        stats.Add(bucket);
+        splits[SPLIT_TRAIN].Write(bucket);
+    };
+
+    Bucket bucket;
+    bucket.features.reserve(bucketSize * nFeatures);
+    bucket.targets.reserve(bucketSize);
+    uint64_t index = 0;
+    uint64_t lineNumber = 1;
+    std::string line;
+    while (std::getline(csv, line))
+    {
+        lineNumber++;
+        if (line.empty())
+        {
+            continue;
+        }
+        const char* p = line.c_str();
+        char* end;
+        std::strtod(p, &end); // ts
+        bool ok = end != p && *end == ',';
+        for (uint32_t c = 0; c <= nFeatures && ok; c++)
+        {
+            p = end + 1;
+            double value = std::strtod(p, &end);
+            ok = end != p && (c < nFeatures ? *end == ',' : *end == '\0' || *end == '\r');
+            (c < nFeatures ? bucket.features : bucket.targets).push_back(value);
+        }
+        if (!ok)
+        {
+            std::cerr << input << ":" << lineNumber << ": expected " << columns.size()
+                      << " numeric columns" << std::endl;
+            return 1;
+        }
+        if (bucket.targets.size() < bucketSize)
+        {
+            continue;
+        }
+
+        SplitKind kind = Classify(seed, index++, validationFraction, testFraction);
+        if (kind != SPLIT_TRAIN)
+        {
+            splits[kind].Write(bucket);
+        }
+        else
+        {
+            held.push_back(bucket);
+            if (held.size() > 2)
+            {
+                writeTrain(held.front());
+                held.pop_front();
+            }
+        }
+        bucket.features.clear();
+        bucket.targets.clear();
+    }
+    uint64_t dropped = bucket.targets.size();
+
+    for (const Bucket& last : held)
+    {
+        if (splits[SPLIT_TEST].buckets == 0)
+        {
+            splits[SPLIT_TEST].Write(last);
+        }
+        else if (splits[SPLIT_VALIDATION].buckets == 0)
+        {
+            splits[SPLIT_VALIDATION].Write(last);
+        }
+        else
+        {
+            writeTrain(last);
+        }
+    }
+    bool written = true;
+    for (SplitWriter& split : splits)
+    {
+        written = split.Close() && written;
+    }
+    if (!written)
+    {
+        std::cerr << "Could not write the tensors to " << output << std::endl;
+        return 1;
+    }
+    for (uint32_t s = 0; s < SPLIT_COUNT; s++)
+    {
+        if (splits[s].buckets == 0)
+        {
+            std::cerr << input << ": " << index << " buckets of " << bucketSize
+                      << " rows leave the " << SPLIT_NAMES[s] << " split empty" << std::endl;
+            return 1;
+        }
+    }
+
+    std::ofstream scaler(output + "/scaler.txt");
+    stats.Write(scaler);
+    std::ofstream manifest(output + "/dataset.txt");
+    manifest << "masticc-dataset 1\n";
+    manifest << "features";
+    for (uint32_t f = 0; f < nFeatures; f++)
+    {
+        manifest << (f ? "," : " ") << columns[f + 1];
+    }
+    manifest << "\ntarget " << columns.back() << "\n";
+    manifest << "seed " << seed << "\nbucket_size " << bucketSize << "\n";
+    for (uint32_t s = 0; s < SPLIT_COUNT; s++)
+    {
+        manifest << SPLIT_NAMES[s] << " " << splits[s].rows << " " << splits[s].buckets << "\n";
+    }
+    if (!scaler || !manifest)
+    {
+        std::cerr << "Could not write the scaler and manifest to " << output << std::endl;
+        return 1;
+    }
+
+    std::cout << "Split " << index << " buckets of " << bucketSize << " rows into";
+    for (uint32_t s = 0; s < SPLIT_COUNT; s++)
+    {
+        std::cout << (s ? ", " : " ") << SPLIT_NAMES[s] << " " << splits[s].buckets;
+    }
+    std::cout << " (" << nFeatures << " features) in " << output << std::endl;
+    if (dropped > 0)
+    {
+        std::cout << dropped << " rows after the last full bucket are left out" << std::endl;
+    }
+    return 0;
+}
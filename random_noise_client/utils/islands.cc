@@ -0,0 +1,191 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Independent star+bottleneck islands, one simulator per island.
+//
+// ns-3's Simulator is a process-wide singleton, so islands cannot run on
+// threads of one process. Each island runs in a forked worker instead; the
+// LSTM model is loaded once before forking and shared copy-on-write, and the
+// workers publish their results to a lock-free SharedResultAggregator.
+//
+//   ./ns3 run "masticc-islands --nIslands=32 --bottleneckRates=1,5,10 --adaptiveClient"
+
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+#include "ns3/random_noise_client-module.h"
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("MasticcIslands");
+
+namespace
+{
+
+/// Metrics published by every island
+enum IslandMetric
+{
+    METRIC_GOODPUT,            //!< Echo goodput of the main client (Mbps)
+    METRIC_ECHOES,             //!< Echoes received by the main client
+    METRIC_EVENTS,             //!< Events executed
+    METRIC_SIMULATED_PER_WALL, //!< Simulated seconds per wall second
+    METRIC_COUNT,
+};
+
+const char* const METRIC_NAMES[METRIC_COUNT] = {
+    "goodput (Mbps)",
+    "echoes",
+    "events",
+    "simulated s per wall s",
+};
+
+uint64_t g_rxBytes = 0; //!< Bytes echoed to the main client of this island
+uint64_t g_echoes = 0;  //!< Echoes received by the main client of this island
+
+void
+CountEcho(Ptr<const Packet> packet)
+{
+    g_rxBytes += packet->GetSize();
+    g_echoes++;
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t nIslands = 4;
+    uint32_t jobs = 0;
+    uint32_t nClients = 2;
+    std::string bottleneckRates = "1"; // Mbps
+    float meanNoiseInterval = 10;      // ms
+    uint32_t meanNoiseSize = 1000;     // bytes
+    double duration = 10;              // s
+    bool adaptiveClient = false;
+    std::string modelFile = "masticc/savedModel.txt";
+    std::string scheduler = "Map";
+    bool telemetry = false;
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("nIslands", "Number of independent islands", nIslands);
+    cmd.AddValue("jobs", "Islands simulated at the same time (0 = number of cores)", jobs);
+    cmd.AddValue("nClients", "Number of clients connected to R1 in every island", nClients);
+    cmd.AddValue("bottleneckRates", "Comma separated bottleneck rates assigned round robin (Mbps)", bottleneckRates);
+    cmd.AddValue("meanNoiseInterval", "Average interval between noise packets (ms)", meanNoiseInterval);
+    cmd.AddValue("meanNoiseSize", "Average size of noise packets (bytes)", meanNoiseSize);
+    cmd.AddValue("duration", "Time the applications run (s)", duration);
+    cmd.AddValue("adaptiveClient", "Use the LSTM-paced RandomNoiseClient as the main client", adaptiveClient);
+    cmd.AddValue("modelFile", "Model of the adaptive client", modelFile);
+    cmd.AddValue("scheduler", "Event scheduler: Map, Heap, Calendar, PriorityQueue or TimingWheel", scheduler);
+    cmd.AddValue("telemetry", "Publish the live state of every island in /dev/shm/masticc-<pid>.telemetry", telemetry);
+    cmd.Parse(argc, argv);
+    SchedulerHelper::Set(scheduler);
+
+    std::vector<uint32_t> rates;
+    std::istringstream list(bottleneckRates);
+    std::string rate;
+    while (std::getline(list, rate, ','))
+    {
+        rates.push_back(std::stoul(rate));
+    }
+    NS_ABORT_MSG_IF(rates.empty(), "No bottleneck rate given");
+
+    if (adaptiveClient)
+    {
+        // held once by the parent, read by every island through the model cache
+        LstmModel::Load(modelFile);
+    }
+    Ptr<SharedResultAggregator> results = Create<SharedResultAggregator>(METRIC_COUNT);
+
+    ReplicationHelper islands;
+    islands.SetReplications(nIslands);
+    islands.SetJobs(jobs);
+    auto start = std::chrono::steady_clock::now();
+    islands.Run([&](uint32_t island, double*) {
+        MasticcTopologyHelper topology;
+        topology.SetNClients(nClients);
+        topology.SetBottleneckLink(DataRate(rates[island % rates.size()] * 1000000), MilliSeconds(10));
+        topology.Install();
+        Time stop = Seconds(duration);
+
+        UdpEchoServerHelper echoServer(9);
+        echoServer.Install(topology.GetServer()).Stop(stop);
+
+        RandomNoiseClientHelper noiseClient(topology.GetServerAddress(), 9);
+        noiseClient.SetAttribute("IntervalMean", DoubleValue(meanNoiseInterval / 1000.));
+        noiseClient.SetAttribute("PacketSizeMean", DoubleValue(meanNoiseSize));
+        double stdev = meanNoiseSize * .3;
+        noiseClient.SetAttribute("PacketSizeVariance", DoubleValue(stdev * stdev));
+        ApplicationContainer noiseApps = noiseClient.Install(topology.GetClient(0));
+        noiseApps.Stop(stop);
+
+        ApplicationContainer clientApps;
+        if (adaptiveClient)
+        {
+            RandomNoiseClientHelper lstmClient(topology.GetServerAddress(), 9);
+            lstmClient.SetAttribute("IntervalMean", DoubleValue(0));
+            lstmClient.SetAttribute("ModelFile", StringValue(modelFile));
+            clientApps = lstmClient.Install(topology.GetClient(1));
+        }
+        else
+        {
+            UdpEchoClientHelper echoClient(topology.GetServerAddress(), 9);
+            echoClient.SetAttribute("MaxPackets", UintegerValue(0));
+            echoClient.SetAttribute("Interval", TimeValue(Seconds(0.1)));
+            echoClient.SetAttribute("PacketSize", UintegerValue(1024));
+            clientApps = echoClient.Install(topology.GetClient(1));
+        }
+        clientApps.Stop(stop);
+        clientApps.Get(0)->TraceConnectWithoutContext("Rx", MakeCallback(&CountEcho));
+
+        // one page per island, named after the process of the island
+        Ptr<TelemetryPage> telemetryPage;
+        if (telemetry)
+        {
+            telemetryPage = CreateObject<TelemetryPage>();
+            telemetryPage->AddClients(noiseApps);
+            telemetryPage->AddClients(clientApps);
+            telemetryPage->Start();
+        }
+
+        Simulator::Stop(stop + Seconds(5));
+        auto runStart = std::chrono::steady_clock::now();
+        Simulator::Run();
+        double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - runStart).count();
+        if (telemetryPage)
+        {
+            telemetryPage->Stop();
+        }
+
+        results->Add(METRIC_GOODPUT, g_rxBytes * 8 / duration / 1e6);
+        results->Add(METRIC_ECHOES, g_echoes);
+        results->Add(METRIC_EVENTS, Simulator::GetEventCount());
+        results->Add(METRIC_SIMULATED_PER_WALL, Simulator::Now().GetSeconds() / wall);
+        Simulator::Destroy();
+    });
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << results->GetCount(METRIC_EVENTS) << " of " << nIslands << " islands completed in "
+              << wall << " s, " << results->GetSum(METRIC_EVENTS) / wall << " events per second\n";
+    for (uint32_t m = 0; m < METRIC_COUNT; m++)
+    {
+        std::cout << "  " << METRIC_NAMES[m] << ": mean " << results->GetMean(m) << ", stdev "
+                  << results->GetStdev(m) << ", min " << results->GetMin(m) << ", max "
+                  << results->GetMax(m) << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,138 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Streaming replacement for process_pcap.py.
+//
+// Reads the client and router1 captures written by network_topology in one
+// pass over memory-mapped files and appends the same columns to
+// latency_data.csv. Memory use does not grow with the trace length.
+// Both pcaps and header summary captures (--traceMode=summary) are accepted.
+//
+//   ./ns3 run "masticc-process-pcap 5" --cwd=masticc
+//   ./ns3 run "masticc-process-pcap 5 --client=../traces/client.mhs
+//              --router=../traces/router1.mhs" --cwd=masticc
+
+#include "ns3/capture_stream.h"
+#include "ns3/command-line.h"
+#include "ns3/latency_features.h"
+#include "ns3/log.h"
+
+#include <arpa/inet.h>
+#include <deque>
+#include <fstream>
+#include <iostream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("MasticcProcessPcap");
+
+int
+main(int argc, char* argv[])
+{
+    double bottleneckRate = 50; // Mbps
+    std::string clientPcap = "../traces/client.pcap";
+    std::string routerPcap = "../traces/router1.pcap";
+    std::string output = "training_data/latency_data.csv";
+    std::string serverAddress = "10.0.2.2";
+    double lossHorizon = 1.0; // s
+    CommandLine cmd(__FILE__);
+    cmd.AddNonOption("bottleneckRate", "Rate of the bottleneck link (Mbps)", bottleneckRate);
+    cmd.AddValue("client", "Capture of the adaptive client", clientPcap);
+    cmd.AddValue("router", "Capture of the bottleneck towards the server", routerPcap);
+    cmd.AddValue("output", "CSV file the rows are appended to", output);
+    cmd.AddValue("server", "Address whose packets are returning echoes", serverAddress);
+    cmd.AddValue("lossHorizon", "Time to wait for an echo before a packet is lost (s)", lossHorizon);
+    cmd.Parse(argc, argv);
+
+    in_addr server;
+    if (inet_pton(AF_INET, serverAddress.c_str(), &server) != 1)
+    {
+        std::cerr << "Invalid server address " << serverAddress << std::endl;
+        return 1;
+    }
+    uint32_t serverIp = ntohl(server.s_addr);
+
+    CaptureStream client;
+    CaptureStream router;
+    if (!client.Open(clientPcap) || !router.Open(routerPcap))
+    {
+        std::cerr << "Could not read " << clientPcap << " and " << routerPcap << std::endl;
+        return 1;
+    }
+
+    bool exists = std::ifstream(output).good();
+    std::ofstream csv(output, std::ios::app);
+    if (!exists)
+    {
+        LatencyFeatureRow::WriteCsvHeader(csv);
+    }
+
+    // like process_pcap.py, drop the first and last four rows
+    const uint32_t trim = 4;
+    uint64_t nRows = 0;
+    std::deque<LatencyFeatureRow> tail;
+    LatencyFeatureExtractor extractor(bottleneckRate * 1e6, lossHorizon);
+    auto drain = [&]() {
+        LatencyFeatureRow row;
+        while (extractor.PopRow(row))
+        {
+            if (nRows++ < trim)
+            {
+                continue;
+            }
+            tail.push_back(row);
+            if (tail.size() > trim)
+            {
+                tail.front().WriteCsv(csv);
+                tail.pop_front();
+            }
+        }
+    };
+
+    // merge both captures in time order, bottleneck packets first on ties
+    CapturedPacket c;
+    CapturedPacket r;
+    bool haveClient = client.Next(c);
+    bool haveRouter = router.Next(r);
+    while (haveClient || haveRouter)
+    {
+        if (haveRouter && (!haveClient || r.time <= c.time))
+        {
+            if (r.src != serverIp) // skip returning echoes
+            {
+                extractor.AddBottleneckPacket(r.time, r.size);
+            }
+            haveRouter = router.Next(r);
+        }
+        else
+        {
+            if (c.udp)
+            {
+                extractor.AddClientPacket(c.time, c.id);
+            }
+            haveClient = client.Next(c);
+        }
+        drain();
+    }
+    extractor.Finish();
+    drain();
+
+    if (nRows == 0)
+    {
+        std::cout << "No latency values found in " << clientPcap << std::endl;
+        return 1;
+    }
+    return 0;
+}
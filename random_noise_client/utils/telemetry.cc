@@ -0,0 +1,171 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Watches the telemetry pages of running simulations.
+//
+// Without a file every /dev/shm/masticc-*.telemetry page is shown, so a sweep
+// can be watched as a whole and a bad point killed by its pid. Pages are only
+// read, the simulations are never slowed down or blocked. Pages stay after
+// their run; --clean removes those whose process has exited.
+//
+//   ./ns3 run "masticc-telemetry --refresh=500"
+//   ./ns3 run "masticc-telemetry /dev/shm/masticc-1234.telemetry --refresh=0"
+
+#include "ns3/command-line.h"
+#include "ns3/telemetry_page.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <dirent.h>
+#include <iomanip>
+#include <iostream>
+#include <signal.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace ns3;
+
+namespace
+{
+
+/**
+ * \param directory directory holding the pages
+ * \return the telemetry pages of the directory, sorted
+ */
+std::vector<std::string>
+FindPages(const std::string& directory)
+{
+    std::vector<std::string> pages;
+    DIR* dir = opendir(directory.c_str());
+    if (!dir)
+    {
+        return pages;
+    }
+    const std::string prefix = "masticc-";
+    const std::string suffix = ".telemetry";
+    while (dirent* entry = readdir(dir))
+    {
+        std::string name = entry->d_name;
+        if (name.size() > prefix.size() + suffix.size() &&
+            name.compare(0, prefix.size(), prefix) == 0 &&
+            name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0)
+        {
+            pages.push_back(directory + "/" + name);
+        }
+    }
+    closedir(dir);
+    std::sort(pages.begin(), pages.end());
+    return pages;
+}
+
+/**
+ * \brief Print one page.
+ * \param file the page
+ * \param clients whether to print the client table
+ * \param exited set when the process of the page is gone
+ * \return true while the simulation of the page is running
+ */
+bool
+PrintPage(const std::string& file, bool clients, bool& exited)
+{
+    exited = false;
+    TelemetryReader reader;
+    TelemetrySnapshot snapshot;
+    if (!reader.Open(file))
+    {
+        std::cout << file << ": not a telemetry page\n";
+        return false;
+    }
+    if (!reader.Read(snapshot))
+    {
+        std::cout << file << ": no consistent copy, the writer died during an update\n";
+        return false;
+    }
+    const TelemetryState& state = snapshot.state;
+    bool alive = kill(snapshot.pid, 0) == 0 || errno == EPERM;
+    exited = !alive;
+    const char* status = state.finished ? "finished" : (alive ? "running" : "exited");
+    std::cout << file << ": pid " << snapshot.pid << ' ' << status << ", " << std::fixed
+              << std::setprecision(3) << state.simTime << " s simulated in " << state.wallTime
+              << " s, " << std::setprecision(0) << state.eventsPerSecond << " events/s, "
+              << std::setprecision(2) << state.simSpeed << "x\n";
+    if (clients)
+    {
+        for (const TelemetryClient& client : snapshot.clients)
+        {
+            std::cout << "  node " << std::setw(4) << client.node << std::setprecision(3)
+                      << "  rate " << std::setw(9) << client.sendRate / 1e6 << " Mbps"
+                      << "  loss " << std::setw(5) << client.loss << "  sent " << client.sent
+                      << "  received " << client.received;
+            if (client.adaptive)
+            {
+                std::cout << "  ratio " << client.predictedRatio << "  latency "
+                          << client.meanLatency * 1e3 << " ms";
+            }
+            std::cout << '\n';
+        }
+    }
+    std::cout.unsetf(std::ios::floatfield);
+    return !state.finished && alive;
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    std::string file;
+    std::string directory = "/dev/shm";
+    uint32_t refresh = 1000; // ms
+    bool clients = true;
+    bool clean = false;
+    CommandLine cmd(__FILE__);
+    cmd.AddNonOption("file", "Telemetry page to watch, empty for every page of the directory", file);
+    cmd.AddValue("directory", "Directory searched for masticc-*.telemetry pages", directory);
+    cmd.AddValue("refresh", "Time between two reads (ms, 0 = read once)", refresh);
+    cmd.AddValue("clients", "Print the state of every client", clients);
+    cmd.AddValue("clean", "Remove the pages of processes that have exited", clean);
+    cmd.Parse(argc, argv);
+
+    while (true)
+    {
+        std::vector<std::string> pages = file.empty() ? FindPages(directory) : std::vector{file};
+        if (pages.empty())
+        {
+            std::cerr << "No telemetry pages in " << directory << std::endl;
+            return 1;
+        }
+        bool running = false;
+        for (const std::string& page : pages)
+        {
+            bool exited;
+            running |= PrintPage(page, clients, exited);
+            if (clean && exited)
+            {
+                unlink(page.c_str());
+            }
+        }
+        std::cout << std::endl;
+        if (refresh == 0 || !running)
+        {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(refresh));
+    }
+    return 0;
+}
@@ -1,3 +1,4 @@
+import os
 import numpy as np
 import pandas as pd
 import random
@@ -11,6 +12,9 @@ from torch.autograd import Variable
 mm = MinMaxScaler()
 ss = StandardScaler()
 dataset_name = 'training_data/latency_data.csv'
+prepared_dir = 'training_data/prepared' # written by masticc-dataset-prep
+seq_length = 10 #samples per training sequence
+bucket_size = 100 #consecutive samples kept together by splitData
 
 def splitData(df, bucket_size):
     nr_entries = len(df)
@@ -61,6 +65,19 @@ def splitData(df, bucket_size):
 
     return df_train, df_test, df_validation
 
+def makeWindows(X_scaled, y_scaled, bucket_size):
+    """sliding windows of seq_length samples, each labelled with its last target; the
+    buckets of a split are unrelated time spans, so no window crosses into the next one"""
+    X_windows = []
+    y_windows = []
+    for start in range(0, len(X_scaled), bucket_size):
+        X_bucket = torch.Tensor(X_scaled[start:start + bucket_size])
+        if len(X_bucket) < seq_length:
+            continue
+        X_windows.append(X_bucket.unfold(0, seq_length, 1).transpose(1, 2))
+        y_windows.append(torch.Tensor(y_scaled[start + seq_length - 1:start + bucket_size]))
+    return torch.cat(X_windows), torch.cat(y_windows)
+
 def processData(df):
     mm = MinMaxScaler()
     ss = StandardScaler()
@@ -71,13 +88,51 @@ def processData(df):
     ss = ss.fit_transform(X)
     mm = mm.fit_transform(y)
 
-    X_scaled = ss[:len(df), :]
-    X_tensors = Variable(torch.Tensor(X_scaled))
-    X_tensors = torch.reshape(X_tensors,  (X_tensors.shape[0], 1, X_tensors.shape[1]))
-    y_scaled = mm[:len(df), :]
-    y_tensors = Variable(torch.Tensor(y_scaled))
-
-    return X_tensors , y_tensors
+    # windows within the buckets of splitData, so the LSTM is trained on the
+    # sequences it sees at runtime
+    X_tensors, y_tensors = makeWindows(ss, mm, bucket_size)
+
+    return Variable(X_tensors), Variable(y_tensors)
+
+def loadScaler(directory):
+    """feature mean, feature scale and target range of the training split"""
+    sections = dict()
+    with open(os.path.join(directory, 'scaler.txt')) as file:
+        file.readline()
+        for header in file:
+            name, count = header.split()
+            sections[name] = np.array(file.readline().split(), dtype=np.float64)
+    return sections['feature_mean'], sections['feature_scale'], sections['target_range']
+
+def saveScaler(df_train, path):
+    """the scalers processData fits on the training split, in the scaler.txt format"""
+    X = df_train.iloc[:, :-1]
+    y = df_train.iloc[:, -1]
+    sections = [('feature_mean', X.mean()), ('feature_scale', X.std(ddof=0)),
+                ('target_range', [y.min(), y.max()])]
+    with open(path, 'w') as file:
+        file.write("scaler " + str(X.shape[1]) + "\n")
+        for name, values in sections:
+            values = list(values)
+            file.write(name + " " + str(len(values)) + "\n")
+            file.write(" ".join(repr(float(value)) for value in values) + "\n")
+
+def loadPrepared(directory, split):
+    """features, targets and bucket size of one split, as written by masticc-dataset-prep"""
+    with open(os.path.join(directory, 'dataset.txt')) as file:
+        manifest = dict(line.split(' ', 1) for line in file.read().splitlines())
+    nr_features = len(manifest['features'].split(','))
+    X = np.fromfile(os.path.join(directory, split + '_x.f32'), dtype=np.float32).reshape(-1, nr_features)
+    y = np.fromfile(os.path.join(directory, split + '_y.f32'), dtype=np.float32).reshape(-1, 1)
+    return X, y, int(manifest['bucket_size'])
+
+def processPrepared(X, y, bucket_size, scaler):
+    """like processData, with the scaler of the training split for every split"""
+    mean, scale, target_range = scaler
+    scale = np.where(scale == 0, 1, scale)
+    X_scaled = (X - mean) / scale
+    y_scaled = (y - target_range[0]) / (target_range[1] - target_range[0])
+    return makeWindows(X_scaled, y_scaled, bucket_size)
 
 def getTrainingData():
     df = pd.read_csv(dataset_name, index_col = 'ts')
@@ -113,7 +168,9 @@ def getTrainingData():
 
 def trainModel(df_train):
     X_train, y_train = processData(df_train)
+    return trainTensors(X_train, y_train)
 
+def trainTensors(X_train, y_train):
     num_epochs = 100000 #1000 epochs
     learning_rate = 0.001 #0.001 lr
 
@@ -201,9 +258,26 @@ def plot(datasets, labels, title):
     plt.legend()
 
 
+def mainPrepared():
+    scaler = loadScaler(prepared_dir)
+    X_train, y_train = processPrepared(*loadPrepared(prepared_dir, 'train'), scaler)
+    lstm = trainTensors(X_train, y_train)
+
+    X_test, y_test = processPrepared(*loadPrepared(prepared_dir, 'test'), scaler)
+    target_min, target_max = scaler[2]
+    data_predict = lstm(X_test).data.numpy() * (target_max - target_min) + target_min
+    dataY_plot = y_test.data.numpy() * (target_max - target_min) + target_min
+    plot([dataY_plot, data_predict],['Actuall Data', 'Predicted Data'],'Time-Series Prediction')
+    plt.show()
+
+    torch.save(lstm.state_dict(), "./savedModel1.pth")
+    print("Export with: python3 exportLSTM.py savedModel1.pth savedModel.txt " + os.path.join(prepared_dir, 'scaler.txt'))
+
 def main():
+    if os.path.exists(os.path.join(prepared_dir, 'dataset.txt')):
+        return mainPrepared()
     df = pd.read_csv(dataset_name, index_col = 'ts')
-    df_train, df_test, df_validation = splitData(df, 100)
+    df_train, df_test, df_validation = splitData(df, bucket_size)
     plt.show()
 
     lstm = trainModel(df_train)
@@ -217,4 +291,6 @@ def main():
     plt.show()
 
     torch.save(lstm.state_dict(), "./savedModel1.pth")
+    saveScaler(df_train, "./savedModel1.scaler.txt")
+    print("Export with: python3 exportLSTM.py savedModel1.pth savedModel.txt savedModel1.scaler.txt")
 main()
@@ -165,7 +165,8 @@ def getResults(lstm, df):
 
     X_scaled = ss[:len(df), :]
     X_tensors = Variable(torch.Tensor(X_scaled))
-    X_tensors = torch.reshape(X_tensors,  (X_tensors.shape[0], 1, X_tensors.shape[1]))
+    # the rows are one time window, feed them as a single sequence
+    X_tensors = torch.reshape(X_tensors,  (1, X_tensors.shape[0], X_tensors.shape[1]))
 
     results = lstm(X_tensors)#forward pass
 